@@ -0,0 +1,57 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+/* Replaces the global operator new and delete to count the heap allocations done by the
+   benchmark. Include it in one translation unit only. */
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Keeps the compiler from seeing through the header in front of each block
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+namespace bench {
+std::size_t allocatedBytes = 0;
+std::size_t allocationCount = 0;
+}
+
+BENCH_NOINLINE void *operator new(std::size_t n) {
+  std::size_t *p = static_cast<std::size_t *>(std::malloc(n + sizeof(max_align_t)));
+  if (!p)
+    throw std::bad_alloc();
+  *p = n;
+  bench::allocatedBytes += n;
+  ++bench::allocationCount;
+  return reinterpret_cast<char *>(p) + sizeof(max_align_t);
+}
+
+BENCH_NOINLINE void operator delete(void *ptr) noexcept {
+  if (!ptr)
+    return;
+  std::size_t *p = reinterpret_cast<std::size_t *>(static_cast<char *>(ptr) - sizeof(max_align_t));
+  bench::allocatedBytes -= *p;
+  std::free(p);
+}
@@ -0,0 +1,63 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* Building and tearing down big graphs, with the edges allocated one by one from the system
+   allocator or from the default property_pool. */
+
+#include "property.h"
+#include "bench.h"
+#include "allocations.h"
+
+#include <vector>
+
+struct system_allocator : property_allocator {
+  void *allocate(std::size_t size) override { return ::operator new(size); }
+  void deallocate(void *p, std::size_t) override { ::operator delete(p); }
+};
+
+static void run(const char *kind, int count) {
+  std::string name = std::string("scene/") + kind + "/nodes:" + std::to_string(count);
+  std::vector<property<int>> *nodes = new std::vector<property<int>>;
+  nodes->reserve(count);
+  std::size_t allocations = bench::allocationCount;
+  double build = bench::seconds([&]{
+    nodes->emplace_back(1);
+    nodes->emplace_back(2);
+    for (int i = 2; i < count; ++i) {
+      property<int> *a = &(*nodes)[i - 1], *b = &(*nodes)[i / 2];
+      nodes->emplace_back([a, b]{ return (a->get() + b->get()) & 0xffff; });
+    }
+  });
+  bench::report(name + "/build_allocations", double(bench::allocationCount - allocations), "allocations");
+  bench::report(name + "/build", build * 1e3, "ms");
+  double teardown = bench::seconds([&]{ delete nodes; });
+  bench::report(name + "/teardown", teardown * 1e3, "ms");
+}
+
+int main() {
+  system_allocator system;
+  for (int count : { 100000, 1000000 }) {
+    property_allocator *pool = property_base::setAllocator(&system);
+    run("system", count);
+    property_base::setAllocator(pool);
+    run("pool", count);
+  }
+}
+
+// c++ -std=c++11 -O2 -I../src ./arena.cc
@@ -0,0 +1,95 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* N entities with an opacity computed from a position and a shared scale, stored as N
+   independent property<float> or as property_array<float> columns. Every frame moves all
+   the entities. */
+
+#include "property.h"
+#include "property_array.h"
+#include "bench.h"
+#include "allocations.h"
+
+#include <vector>
+
+static void independent(int count) {
+  std::string name = "entities/property/count:" + std::to_string(count);
+  std::size_t bytes = bench::allocatedBytes;
+  property<float> scale = 0.5f;
+  std::vector<property<float>> x(count, property<float>(0.f));
+  std::vector<property<float>> opacity;
+  opacity.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    property<float> *xi = &x[i];
+    opacity.emplace_back([xi, &scale]{ return xi->get() * scale + 1.f; });
+  }
+  bench::report(name + "/memory_per_entity", double(bench::allocatedBytes - bytes) / count, "bytes");
+
+  const int frames = 20;
+  double s = bench::seconds([&]{
+    for (int f = 0; f < frames; ++f) {
+      property_base::batch b;
+      for (int i = 0; i < count; ++i)
+        x[i] = float(i + f);
+    }
+  });
+  bench::report(name + "/frame_per_entity", s / (frames * count) * 1e9, "ns");
+  for (int i = 0; i < count; ++i) {
+    if (opacity[i].get() != float(i + frames - 1) * 0.5f + 1.f) {
+      std::cerr << "wrong result" << std::endl;
+      break;
+    }
+  }
+}
+
+static void columns(int count) {
+  std::string name = "entities/property_array/count:" + std::to_string(count);
+  std::size_t bytes = bench::allocatedBytes;
+  property_array<float> scale(count, 0.5f);
+  property_array<float> x(count, 0.f);
+  property_array<float> opacity(count);
+  opacity.bind([](float xi, float s) { return xi * s + 1.f; }, x, scale);
+  bench::report(name + "/memory_per_entity", double(bench::allocatedBytes - bytes) / count, "bytes");
+
+  const int frames = 20;
+  double s = bench::seconds([&]{
+    for (int f = 0; f < frames; ++f) {
+      x.update([f](float *data, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i)
+          data[i] = float(i + f);
+      });
+    }
+  });
+  bench::report(name + "/frame_per_entity", s / (frames * count) * 1e9, "ns");
+  for (int i = 0; i < count; ++i) {
+    if (opacity[i] != float(i + frames - 1) * 0.5f + 1.f) {
+      std::cerr << "wrong result" << std::endl;
+      break;
+    }
+  }
+}
+
+int main() {
+  for (int count : { 1000, 100000 }) {
+    independent(count);
+    columns(count);
+  }
+}
+
+// c++ -std=c++11 -O3 -I../src ./array.cc
@@ -0,0 +1,69 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* A few inputs (width, height, margin) read by many bindings, as in a layout.
+   Updating the inputs one after the other re-evaluates every binding once per input,
+   updating them in a batch re-evaluates every binding once. */
+
+#include "property.h"
+#include "bench.h"
+
+#include <memory>
+#include <vector>
+
+static void run(int bindings, bool batched) {
+  property<int> width = 0, height = 0, margin = 0;
+  long evaluations = 0;
+  std::vector<std::unique_ptr<property<int>>> layout;
+  for (int i = 0; i < bindings; ++i) {
+    layout.emplace_back(new property<int>([&, i]{
+      ++evaluations;
+      return (width - 2 * margin) * i + height;
+    }));
+  }
+
+  const int storms = 1000;
+  evaluations = 0;
+  double s = bench::seconds([&]{
+    for (int i = 0; i < storms; ++i) {
+      if (batched) {
+        property_base::batch b;
+        width = i;
+        height = i;
+        margin = i;
+      } else {
+        width = i;
+        height = i;
+        margin = i;
+      }
+    }
+  });
+  std::string name = std::string("storm/") + (batched ? "batched" : "unbatched") + "/bindings:" + std::to_string(bindings);
+  bench::report(name + "/evaluations_per_storm", double(evaluations) / storms, "evaluations");
+  bench::report(name + "/storm", s / storms * 1e9, "ns");
+}
+
+int main() {
+  for (int bindings : { 1, 10, 100, 1000 }) {
+    run(bindings, false);
+    run(bindings, true);
+  }
+}
+
+// c++ -std=c++11 -O2 -I../src ./batch.cc
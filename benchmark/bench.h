@@ -0,0 +1,53 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+/* Tiny helpers shared by the benchmarks: time a piece of code and report the result
+   as one "name value unit" line, easy to diff between two builds.
+   With BENCH_FORMAT=json in the environment, every result is a JSON object on its own line
+   instead, as collected by the run_benchmarks target and read by compare.py. */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace bench {
+
+template<typename F> double seconds(F f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline bool json() {
+  static const bool enabled = std::getenv("BENCH_FORMAT") && !std::strcmp(std::getenv("BENCH_FORMAT"), "json");
+  return enabled;
+}
+
+inline void report(const std::string &name, double value, const char *unit) {
+  if (json())
+    std::cout << "{\"name\":\"" << name << "\",\"value\":" << value << ",\"unit\":\"" << unit << "\"}" << std::endl;
+  else
+    std::cout << name << " " << value << " " << unit << std::endl;
+}
+
+}
@@ -0,0 +1,109 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* Cost of creating and calling a binding stored in std::function, in property_function,
+   and directly with its own type in a bound_property. */
+
+#include "property.h"
+#include "bench.h"
+#include "allocations.h"
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+
+template <typename Function, int Captures> struct capture_test {
+  static void run(const char *kind) {
+    long data[Captures];
+    for (int i = 0; i < Captures; ++i)
+      data[i] = i;
+    long *p = data;
+    const int count = 1000000;
+    std::vector<Function> functions;
+    functions.reserve(count);
+    std::size_t allocations = bench::allocationCount;
+    double create = bench::seconds([&]{
+      for (int i = 0; i < count; ++i) {
+        // 'copy' makes the capture Captures pointers big
+        std::array<long *, Captures> copy;
+        copy.fill(p + i % Captures);
+        functions.emplace_back([copy]{ return *copy[0] + *copy[Captures - 1]; });
+      }
+    });
+    std::string name = std::string("function/") + kind + "/capture_bytes:" + std::to_string(Captures * sizeof(void *));
+    bench::report(name + "/allocations_per_creation", double(bench::allocationCount - allocations) / count, "allocations");
+    bench::report(name + "/create", create / count * 1e9, "ns");
+    long sum = 0;
+    double call = bench::seconds([&]{
+      for (int r = 0; r < 10; ++r) {
+        for (const Function &f : functions)
+          sum += f();
+      }
+    });
+    bench::report(name + "/call", call / (10 * count) * 1e9, "ns");
+    if (sum < 0)
+      std::cerr << sum;
+  }
+};
+
+template <typename P> static void evaluateChain(const char *kind, std::vector<std::unique_ptr<P>> &chain, property<int> &source) {
+  const int writes = 100000;
+  double s = bench::seconds([&]{
+    for (int i = 0; i < writes; ++i)
+      source = i;
+  });
+  bench::report(std::string("chain/") + kind + "/length:" + std::to_string(chain.size()) + "/write",
+                s / writes * 1e9, "ns");
+}
+
+int main() {
+  capture_test<std::function<long()>, 1>::run("std::function");
+  capture_test<property_function<long()>, 1>::run("property_function");
+  capture_test<std::function<long()>, 3>::run("std::function");
+  capture_test<property_function<long()>, 3>::run("property_function");
+  capture_test<std::function<long()>, 5>::run("std::function");
+  capture_test<property_function<long()>, 5>::run("property_function");
+
+  const int length = 20;
+  {
+    property<int> source = 0;
+    std::vector<std::unique_ptr<property<int>>> chain;
+    property<int> *previous = &source;
+    for (int i = 0; i < length; ++i) {
+      chain.emplace_back(new property<int>([previous]{ return previous->get() + 1; }));
+      previous = chain.back().get();
+    }
+    evaluateChain("property", chain, source);
+  }
+  {
+    property<int> source = 0;
+    auto binding = [](property<int> *previous) { return [previous]{ return previous->get() + 1; }; };
+    typedef bound_property<int, decltype(binding(nullptr))> bound;
+    std::vector<std::unique_ptr<bound>> chain;
+    property<int> *previous = &source;
+    for (int i = 0; i < length; ++i) {
+      chain.emplace_back(new bound(binding(previous)));
+      previous = chain.back().get();
+    }
+    evaluateChain("bound_property", chain, source);
+  }
+}
+
+// c++ -std=c++11 -O2 -I../src ./binding.cc
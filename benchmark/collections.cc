@@ -0,0 +1,90 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* A large model list with derived views: the even elements, their sum, and the number of
+   elements above a threshold. Every step appends an element and updates another one.
+   With property<std::vector<int>>, every step assigns a new vector and the views are
+   computed again from scratch; with property_list, the operators only apply the changes. */
+
+#include "property.h"
+#include "property_collection.h"
+#include "bench.h"
+
+#include <vector>
+
+static void whole(int size, int steps) {
+  property<std::vector<int>> list = std::vector<int>(size, 1);
+  property<std::vector<int>> even = [&]{
+    std::vector<int> r;
+    for (int v : list())
+      if (v % 2 == 0)
+        r.push_back(v);
+    return r;
+  };
+  property<long> sum = [&]{
+    long s = 0;
+    for (int v : even())
+      s += v;
+    return s;
+  };
+  property<std::size_t> large = [&]{
+    std::size_t n = 0;
+    for (int v : list())
+      n += v > 50;
+    return n;
+  };
+  double s = bench::seconds([&]{
+    for (int i = 0; i < steps; ++i) {
+      list.modify([&](std::vector<int> &v) {
+        v.push_back(i % 100);
+        v[i % size] = i % 7;
+      });
+    }
+  });
+  bench::report("collections/whole/size:" + std::to_string(size) + "/step", s / steps * 1e9, "ns");
+  if (sum < 0 || large > list().size())
+    std::cerr << "wrong result" << std::endl;
+}
+
+static void incremental(int size, int steps) {
+  property_list<int> list(std::vector<int>(size, 1));
+  auto even = make_list_filter(list, [](int v) { return v % 2 == 0; });
+  auto sum = make_sum(even);
+  auto large = make_count(list, [](int v) { return v > 50; });
+  double s = bench::seconds([&]{
+    for (int i = 0; i < steps; ++i) {
+      property_base::batch b;
+      list.push_back(i % 100);
+      list.set(i % size, i % 7);
+    }
+  });
+  bench::report("collections/incremental/size:" + std::to_string(size) + "/step", s / steps * 1e9, "ns");
+  if (sum < 0 || large > list.size())
+    std::cerr << "wrong result" << std::endl;
+}
+
+int main() {
+  for (int size : { 100, 10000, 1000000 }) {
+    int steps = 10000000 / size;
+    whole(size, std::min(steps, 10000));
+    incremental(size, 10000);
+  }
+}
+
+// c++ -std=c++11 -O2 -I../src ./collections.cc
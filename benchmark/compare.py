@@ -0,0 +1,37 @@
+#!/usr/bin/env python3
+"""Compares two result files written by the run_benchmarks target.
+
+    compare.py baseline.jsonl candidate.jsonl
+
+Prints every result found in both files with the ratio candidate / baseline."""
+
+import json
+import sys
+
+
+def load(path):
+    results = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith("{"):
+                r = json.loads(line)
+                results[r["name"]] = (r["value"], r["unit"])
+    return results
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    baseline, candidate = load(sys.argv[1]), load(sys.argv[2])
+    width = max((len(name) for name in candidate), default=0)
+    for name, (value, unit) in candidate.items():
+        if name not in baseline:
+            continue
+        before = baseline[name][0]
+        ratio = value / before if before else float("nan")
+        print("%-*s %12g %12g %-12s %6.2fx" % (width, name, before, value, unit, ratio))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,60 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* A quantizing binding in front of a wide downstream graph: most writes to the source do
+   not change the quantized value, and with the equality cutoff they stop there. */
+
+#include "property.h"
+#include "bench.h"
+
+#include <memory>
+#include <vector>
+
+static void run(int downstream, bool cutoff) {
+  property<int> source = 0;
+  property<int> quantized = [&]{ return source / 100; };
+  quantized.setEqualityCutoff(cutoff);
+  long evaluations = 0;
+  std::vector<std::unique_ptr<property<int>>> nodes;
+  for (int i = 0; i < downstream; ++i)
+    nodes.emplace_back(new property<int>([&, i]{ ++evaluations; return quantized + i; }));
+
+  const int writes = 10000;
+  evaluations = 0;
+  property_base::cutoff_statistics before = property_base::cutoffStatistics();
+  double s = bench::seconds([&]{
+    for (int i = 0; i < writes; ++i)
+      source = i;
+  });
+  const property_base::cutoff_statistics &after = property_base::cutoffStatistics();
+  std::string name = std::string("quantize/") + (cutoff ? "cutoff" : "no_cutoff") + "/downstream:" + std::to_string(downstream);
+  bench::report(name + "/evaluations_per_write", double(evaluations) / writes, "evaluations");
+  bench::report(name + "/cutoffs", after.cutoffs - before.cutoffs, "cutoffs");
+  bench::report(name + "/skipped_subscribers", after.skippedSubscribers - before.skippedSubscribers, "evaluations");
+  bench::report(name + "/write", s / writes * 1e9, "ns");
+}
+
+int main() {
+  for (int downstream : { 1, 10, 100 }) {
+    run(downstream, false);
+    run(downstream, true);
+  }
+}
+
+// c++ -std=c++11 -O2 -I../src ./cutoff.cc
@@ -0,0 +1,63 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* A chain of diamonds: each level has two properties reading the previous join, and a join
+   reading both of them.  Recursive notification evaluates level n 2^n times per write,
+   topologically ordered propagation evaluates every binding exactly once. */
+
+#include "property.h"
+#include "bench.h"
+
+#include <memory>
+#include <vector>
+
+struct diamond_chain {
+  property<int> source = 0;
+  std::vector<std::unique_ptr<property<int>>> nodes;
+  long evaluations = 0;
+
+  explicit diamond_chain(int depth) {
+    property<int> *join = &source;
+    for (int i = 0; i < depth; ++i) {
+      property<int> *left = new property<int>([this, join]{ ++evaluations; return join->get() + 1; });
+      property<int> *right = new property<int>([this, join]{ ++evaluations; return join->get() * 2; });
+      join = new property<int>([this, left, right]{ ++evaluations; return left->get() + right->get(); });
+      nodes.emplace_back(left);
+      nodes.emplace_back(right);
+      nodes.emplace_back(join);
+    }
+  }
+};
+
+int main() {
+  for (int depth : { 4, 16, 64, 1024 }) {
+    diamond_chain chain(depth);
+    const int writes = 1000;
+    chain.evaluations = 0;
+    double s = bench::seconds([&]{
+      for (int i = 0; i < writes; ++i)
+        chain.source = i;
+    });
+    std::string name = "diamond/depth:" + std::to_string(depth);
+    bench::report(name + "/evaluations_per_write", double(chain.evaluations) / writes, "evaluations");
+    bench::report(name + "/write", s / writes * 1e9, "ns");
+  }
+}
+
+// c++ -std=c++11 -O2 -I../src ./diamond.cc
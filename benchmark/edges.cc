@@ -0,0 +1,129 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* Memory used by the dependency graph, and throughput of binding and unbinding,
+   compared with the previous layout using two std::unordered_set per property. */
+
+#include "property.h"
+#include "bench.h"
+#include "allocations.h"
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+using bench::allocatedBytes;
+
+// A property that only exercises the graph bookkeeping
+struct node : property_base {
+  void evaluate() override {}
+  void bind(const std::vector<node *> &deps) {
+    evaluation_scope scope(this);
+    for (node *d : deps)
+      d->accessed();
+  }
+  void unbind() { clearDependencies(); }
+};
+
+// The same bookkeeping with the previous layout
+struct legacy_node {
+  std::unordered_set<legacy_node *> subscribers;
+  std::unordered_set<legacy_node *> dependencies;
+  unsigned height = 0;
+  bool scheduled = false;
+  static legacy_node *current;
+
+  virtual ~legacy_node() { unbind(); for (legacy_node *p : subscribers) p->dependencies.erase(this); }
+  virtual void evaluate() {}
+  void bind(const std::vector<legacy_node *> &deps) {
+    legacy_node *previous = current;
+    current = this;
+    for (legacy_node *d : deps) {
+      d->subscribers.insert(this);
+      dependencies.insert(d);
+    }
+    current = previous;
+  }
+  void unbind() {
+    for (legacy_node *p : dependencies)
+      p->subscribers.erase(this);
+    dependencies.clear();
+  }
+};
+legacy_node *legacy_node::current = nullptr;
+
+template<typename Node> static void run(const char *layout, int count, int edges) {
+  std::string name = std::string("edges/") + layout + "/edges_per_node:" + std::to_string(edges);
+  std::size_t before;
+  {
+    // A pool of our own, so its chunks are counted and released at the end
+    property_pool pool;
+    property_allocator *previous = property_base::setAllocator(&pool);
+    before = allocatedBytes;
+    std::vector<std::unique_ptr<Node>> nodes;
+    nodes.reserve(count);
+    for (int i = 0; i < count; ++i)
+      nodes.emplace_back(new Node);
+    std::vector<std::vector<Node *>> deps(count);
+    for (int i = edges; i < count; ++i) {
+      for (int j = 1; j <= edges; ++j)
+        deps[i].push_back(nodes[i - j].get());
+    }
+    std::size_t depsBytes = allocatedBytes;
+
+    double bind = bench::seconds([&]{
+      for (int i = 0; i < count; ++i)
+        nodes[i]->bind(deps[i]);
+    });
+    bench::report(name + "/memory_per_node",
+                  double(allocatedBytes - depsBytes) / count + sizeof(Node), "bytes");
+    bench::report(name + "/bind", bind / count * 1e9, "ns");
+
+    double unbind = bench::seconds([&]{
+      for (int i = 0; i < count; ++i)
+        nodes[i]->unbind();
+    });
+    bench::report(name + "/unbind", unbind / count * 1e9, "ns");
+
+    const int rounds = 10;
+    double churn = bench::seconds([&]{
+      for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < count; ++i) {
+          nodes[i]->bind(deps[i]);
+          nodes[i]->unbind();
+        }
+      }
+    });
+    bench::report(name + "/bind_unbind", churn / (rounds * count) * 1e9, "ns");
+    nodes.clear();
+    property_base::setAllocator(previous);
+  }
+  if (allocatedBytes != before)
+    std::cerr << "leak in " << name << std::endl;
+}
+
+int main() {
+  const int count = 100000;
+  for (int edges : { 1, 3, 8 }) {
+    run<legacy_node>("unordered_set", count, edges);
+    run<node>("intrusive", count, edges);
+  }
+}
+
+// c++ -std=c++11 -O2 -I../src ./edges.cc
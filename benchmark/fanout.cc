@@ -0,0 +1,66 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* Write throughput on a source with many subscribers. notify() walks the subscriber list in
+   place; as a reference, the cost of the snapshot of the subscribers that it used to take
+   before evaluating them is also reported. */
+
+#include "property.h"
+#include "bench.h"
+
+#include <unordered_set>
+#include <vector>
+
+static void run(int subscribers) {
+  property<int> source = 0;
+  std::vector<property<int>> nodes;
+  nodes.reserve(subscribers);
+  for (int i = 0; i < subscribers; ++i)
+    nodes.emplace_back([&source, i]{ return source + i; });
+
+  const int writes = 1000;
+  double s = bench::seconds([&]{
+    for (int i = 0; i < writes; ++i)
+      source = i;
+  });
+  std::string name = "fan_out/subscribers:" + std::to_string(subscribers);
+  bench::report(name + "/write", s / writes * 1e6, "us");
+  bench::report(name + "/per_subscriber", s / writes / subscribers * 1e9, "ns");
+
+  std::unordered_set<property_base *> set;
+  for (property<int> &p : nodes)
+    set.insert(&p);
+  std::size_t sum = 0;
+  double copy = bench::seconds([&]{
+    for (int i = 0; i < writes; ++i) {
+      std::unordered_set<property_base *> snapshot = set;
+      sum += snapshot.size();
+    }
+  });
+  bench::report(name + "/unordered_set_snapshot", copy / writes * 1e6, "us");
+  if (sum != std::size_t(writes) * subscribers)
+    std::cerr << "wrong result" << std::endl;
+}
+
+int main() {
+  for (int subscribers : { 100, 1000, 10000 })
+    run(subscribers);
+}
+
+// c++ -std=c++11 -O2 -I../src ./fanout.cc
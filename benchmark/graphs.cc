@@ -0,0 +1,135 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* The basic shapes of graphs at scale: write throughput along a chain and into a wide fan-in,
+   the cost of binding and unbinding a property, and the memory used per node of a chain,
+   edges included. */
+
+#include "property.h"
+#include "bench.h"
+#include "allocations.h"
+
+#include <memory>
+#include <vector>
+
+using bench::allocatedBytes;
+
+static void chain(int length) {
+  property<int> source = 0;
+  std::vector<std::unique_ptr<property<int>>> nodes;
+  property<int> *previous = &source;
+  for (int i = 0; i < length; ++i) {
+    nodes.emplace_back(new property<int>([previous]{ return previous->get() + 1; }));
+    previous = nodes.back().get();
+  }
+  const int writes = 10000000 / length;
+  double s = bench::seconds([&]{
+    for (int i = 1; i <= writes; ++i)
+      source = i;
+  });
+  std::string name = "graphs/chain/length:" + std::to_string(length);
+  bench::report(name + "/write", s / writes * 1e9, "ns");
+  bench::report(name + "/per_node", s / writes / length * 1e9, "ns");
+  if (previous->get() != writes + length)
+    std::cerr << "wrong result" << std::endl;
+}
+
+static void fanIn(int inputs) {
+  std::vector<std::unique_ptr<property<int>>> sources;
+  for (int i = 0; i < inputs; ++i)
+    sources.emplace_back(new property<int>(i));
+  property<long> sum = [&]{
+    long s = 0;
+    for (auto &p : sources)
+      s += p->get();
+    return s;
+  };
+  const int writes = 10000000 / inputs;
+  double s = bench::seconds([&]{
+    for (int i = 0; i < writes; ++i)
+      *sources[i % inputs] = sources[i % inputs]->get() + 1;
+  });
+  std::string name = "graphs/fan_in/inputs:" + std::to_string(inputs);
+  bench::report(name + "/write", s / writes * 1e9, "ns");
+  if (sum.get() != long(inputs) * (inputs - 1) / 2 + writes)
+    std::cerr << "wrong result" << std::endl;
+}
+
+// Assigning a binding reading 'dependencies' properties, then a value, which drops the edges
+static void churn(int dependencies) {
+  std::vector<std::unique_ptr<property<int>>> sources;
+  for (int i = 0; i < dependencies; ++i)
+    sources.emplace_back(new property<int>(i));
+  property<int> target;
+  const int rounds = 2000000 / dependencies;
+  long sum = 0;
+  double s = bench::seconds([&]{
+    for (int i = 0; i < rounds; ++i) {
+      target = [&]{
+        int s = 0;
+        for (auto &p : sources)
+          s += p->get();
+        return s;
+      };
+      sum += target.get();
+      target = i;
+    }
+  });
+  std::string name = "graphs/churn/dependencies:" + std::to_string(dependencies);
+  bench::report(name + "/bind_unbind", s / rounds * 1e9, "ns");
+  if (sum != long(rounds) * dependencies * (dependencies - 1) / 2)
+    std::cerr << "wrong result" << std::endl;
+}
+
+static void memory(int length) {
+  std::size_t before;
+  std::size_t used;
+  {
+    property_pool pool;
+    property_allocator *previous = property_base::setAllocator(&pool);
+    before = allocatedBytes;
+    {
+      property<int> source = 0;
+      std::vector<std::unique_ptr<property<int>>> nodes;
+      nodes.reserve(length);
+      property<int> *last = &source;
+      for (int i = 0; i < length; ++i) {
+        nodes.emplace_back(new property<int>([last]{ return last->get() + 1; }));
+        last = nodes.back().get();
+      }
+      used = allocatedBytes - before;
+    }
+    property_base::setAllocator(previous);
+  }
+  bench::report("graphs/memory/length:" + std::to_string(length) + "/per_node", double(used) / length, "bytes");
+  if (allocatedBytes != before)
+    std::cerr << "leak" << std::endl;
+}
+
+int main() {
+  for (int length : { 10, 1000, 100000 })
+    chain(length);
+  for (int inputs : { 10, 1000, 100000 })
+    fanIn(inputs);
+  for (int dependencies : { 1, 10, 100 })
+    churn(dependencies);
+  memory(100000);
+}
+
+// c++ -std=c++11 -O2 -I../src ./graphs.cc
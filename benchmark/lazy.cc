@@ -0,0 +1,63 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* A source feeding a chain of bindings, written many times between two reads of the end
+   of the chain.  Eager bindings re-evaluate the whole chain on every write, lazy ones only
+   when the end of the chain is read. */
+
+#include "property.h"
+#include "bench.h"
+
+#include <memory>
+#include <vector>
+
+static void run(int length, bool lazy) {
+  property<int> source = 0;
+  std::vector<std::unique_ptr<property<int>>> chain;
+  property<int> *previous = &source;
+  for (int i = 0; i < length; ++i) {
+    property<int> *p = new property<int>([previous]{ return previous->get() + 1; });
+    p->setLazy(lazy);
+    chain.emplace_back(p);
+    previous = p;
+  }
+
+  const int frames = 1000, writesPerFrame = 100;
+  long sum = 0;
+  double s = bench::seconds([&]{
+    for (int f = 0; f < frames; ++f) {
+      for (int w = 0; w < writesPerFrame; ++w)
+        source = f * writesPerFrame + w;
+      sum += previous->get();
+    }
+  });
+  std::string name = std::string("chain/") + (lazy ? "lazy" : "eager") + "/length:" + std::to_string(length);
+  bench::report(name + "/write", s / (frames * writesPerFrame) * 1e9, "ns");
+  if (sum != long(frames) * length + long(writesPerFrame) * frames * (frames - 1) / 2 + long(writesPerFrame - 1) * frames)
+    std::cerr << "wrong result" << std::endl;
+}
+
+int main() {
+  for (int length : { 1, 10, 100 }) {
+    run(length, false);
+    run(length, true);
+  }
+}
+
+// c++ -std=c++11 -O2 -I../src ./lazy.cc
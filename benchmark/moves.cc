@@ -0,0 +1,76 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* Heap allocations and time per operation on properties holding a long std::string and a
+   std::vector: writing a copy or moving the value in, appending to it through a copy or with
+   modify(), and reading a cached property_wrapper by value or by reference. */
+
+#include "property.h"
+#include "bench.h"
+#include "allocations.h"
+
+#include <string>
+#include <vector>
+
+using bench::allocationCount;
+
+template <typename F> static void run(const std::string &name, int count, F f) {
+  std::size_t before = allocationCount;
+  double s = bench::seconds([&]{
+    for (int i = 0; i < count; ++i)
+      f(i);
+  });
+  bench::report("moves/" + name + "/allocations", double(allocationCount - before) / count, "allocations");
+  bench::report("moves/" + name + "/time", s / count * 1e9, "ns");
+}
+
+template <typename T> static void payload(const std::string &type, const T &initial, void (*append)(T &)) {
+  const int count = 100000;
+  property<T> p;
+  std::size_t size = 0;
+  property<std::size_t> length = [&]{ return p().size(); };
+
+  // Assigning a copy reuses the capacity of the current value, initializing one cannot
+  std::vector<T> values(count, initial);
+  run(type + "/init_copy", count, [&](int i) { property<T> q(values[i]); size += q().size(); });
+  run(type + "/init_move", count, [&](int i) { property<T> q(std::move(values[i])); size += q().size(); });
+  values.assign(count, initial);
+  run(type + "/write_copy", count, [&](int i) { p = values[i]; });
+  run(type + "/write_move", count, [&](int i) { p = std::move(values[i]); });
+
+  p = initial;
+  run(type + "/append_copy", 1000, [&](int) { T v = p; append(v); p = v; });
+  p = initial;
+  run(type + "/append_modify", 1000, [&](int) { p.modify(append); });
+
+  T backing = initial;
+  property_wrapper<T> wrapper([&](const T &v) { backing = v; }, [&]{ return backing; });
+  wrapper.setCached(true);
+  run(type + "/wrapper_read_value", count, [&](int) { size += wrapper.get().size(); });
+  run(type + "/wrapper_read_reference", count, [&](int) { size += wrapper.getReference().size(); });
+  if (size != 4 * count * initial.size() || length != p().size())
+    std::cerr << "wrong result" << std::endl;
+}
+
+int main() {
+  payload<std::string>("string", std::string(100, 'x'), [](std::string &s) { s += 'y'; });
+  payload<std::vector<int>>("vector", std::vector<int>(100, 1), [](std::vector<int> &v) { v.push_back(2); });
+}
+
+// c++ -std=c++11 -O2 -I../src ./moves.cc
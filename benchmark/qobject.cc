@@ -0,0 +1,63 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* Reading and writing QObject properties through property_qobject, which calls the typed
+   getter and setter when T is the type of the property, compared with the QVariant path of
+   QMetaProperty::read and QMetaProperty::write. */
+
+#include "property_qobject.h"
+#include "bench.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QTimer>
+
+template <typename F> static void run(const std::string &name, F f) {
+  const int count = 1000000;
+  long sum = 0;
+  double s = bench::seconds([&]{
+    for (int i = 0; i < count; ++i)
+      sum += f(i);
+  });
+  bench::report("qobject/" + name, s / count * 1e9, "ns");
+  if (sum == 42)
+    std::cerr << sum;
+}
+
+int main(int argc, char **argv) {
+  QCoreApplication app(argc, argv);
+  QTimer timer;
+  const QMetaObject *mo = timer.metaObject();
+  QMetaProperty intervalProperty = mo->property(mo->indexOfProperty("interval"));
+  QMetaProperty nameProperty = mo->property(mo->indexOfProperty("objectName"));
+  property_qobject<int> interval { &timer, "interval" };
+  property_qobject<QString> objectName { &timer, "objectName" };
+
+  run("int/qvariant/read", [&](int) { return qvariant_cast<int>(intervalProperty.read(&timer)); });
+  run("int/typed/read", [&](int) { return interval.get(); });
+  run("int/qvariant/write", [&](int i) { return intervalProperty.write(&timer, QVariant::fromValue(i)); });
+  run("int/typed/write", [&](int i) { interval = i; return 0; });
+
+  const QString names[] = { QStringLiteral("first"), QStringLiteral("second") };
+  run("QString/qvariant/read", [&](int) { return qvariant_cast<QString>(nameProperty.read(&timer)).size(); });
+  run("QString/typed/read", [&](int) { return objectName.get().size(); });
+  run("QString/qvariant/write", [&](int i) { return nameProperty.write(&timer, QVariant::fromValue(names[i & 1])); });
+  run("QString/typed/write", [&](int i) { objectName = names[i & 1]; return 0; });
+}
+
+// c++ -std=c++11 -O2 -I../src -lQt5Core -fPIC -I/usr/include/qt ./qobject.cc
@@ -0,0 +1,100 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* Replays a trace recorded with property_recorder.h and reports the time the engine spends
+   in its propagations:
+     bench_replay session.trace
+   Without argument, replays a synthetic trace of a layered graph, where every property
+   depends on two properties of the previous layer, written one source at a time and in
+   batches. */
+
+#include "property_replay.h"
+#include "bench.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using property_trace::op;
+
+static void layered(const char *path, int layers, int width, int writes) {
+  property_trace::writer out(path);
+  std::uint64_t next = 0;
+  std::vector<std::uint64_t> previous, layer;
+  for (int i = 0; i < width; ++i) {
+    out.event(op::create);
+    previous.push_back(next++);
+  }
+  const std::vector<std::uint64_t> sources = previous;
+  for (int l = 0; l < layers; ++l) {
+    layer.clear();
+    for (int i = 0; i < width; ++i) {
+      out.event(op::create);
+      out.event(op::dependencies, next, { previous[i], previous[(i + 1) % width] });
+      layer.push_back(next++);
+    }
+    previous = layer;
+  }
+  for (int w = 0; w < writes; ++w) {
+    bool batch = w % 2;
+    if (batch)
+      out.event(op::batch_begin);
+    out.event(op::write, sources[w % width]);
+    if (batch) {
+      out.event(op::write, sources[(w + width / 2) % width]);
+      out.event(op::batch_end);
+    }
+  }
+}
+
+static void replay(const std::string &name, const char *path, int repeat) {
+  property_replayer replayer(path);
+  if (!replayer.isValid()) {
+    std::cerr << path << ": not a valid trace" << std::endl;
+    return;
+  }
+  double best = 0;
+  for (int i = 0; i < repeat; ++i) {
+    if (!replayer.run()) {
+      std::cerr << path << ": inconsistent trace" << std::endl;
+      return;
+    }
+    double t = replayer.statistics().time.count();
+    if (i == 0 || t < best)
+      best = t;
+  }
+  const property_replayer::replay_statistics &s = replayer.statistics();
+  bench::report(name + "/propagation", best / s.propagations, "ns");
+  bench::report(name + "/evaluation", best / s.evaluations, "ns");
+  bench::report(name + "/evaluations_per_propagation", double(s.evaluations) / s.propagations, "");
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    for (int i = 1; i < argc; ++i)
+      replay(std::string("replay/") + argv[i], argv[i], 5);
+    return 0;
+  }
+  const char *path = "replay-layered.trace";
+  layered(path, 10, 1000, 20000);
+  replay("replay/layered/layers:10/width:1000", path, 5);
+  std::remove(path);
+}
+
+// c++ -std=c++11 -O2 -I../src ./replay.cc
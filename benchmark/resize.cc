@@ -0,0 +1,105 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* A resize storm on an offscreen window laid out like the browser example: the window is
+   resized several times per event loop iteration, and a slider is moved as many times with a
+   label showing its value. We report the time per frame and the number of binding evaluations
+   per frame, with the notifications delivered synchronously and coalesced by the
+   property_update_coalescer.
+   Run with QT_QPA_PLATFORM=offscreen. */
+
+#include "property.h"
+#include "qobject_wrappers.h"
+#include "bench.h"
+
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QSlider>
+
+static long evaluations = 0;
+
+struct Window : QtWrapper::Widget<QWidget> {
+    QtWrapper::Label<QPushButton> nextButton { QStringLiteral("Next"), this };
+    QtWrapper::Label<QPushButton> prevButton { QStringLiteral("Previous"), this };
+    QtWrapper::AbstractSlider<QSlider> slider { Qt::Horizontal, this };
+    QtWrapper::Label<QLabel> label { this };
+    QtWrapper::Widget<QWidget> content { this };
+    ::property<int> margin { 10 };
+
+    explicit Window(bool coalesced) {
+        setGeometryCoalesced(coalesced);
+        content.setGeometryCoalesced(coalesced);
+        nextButton.setGeometryCoalesced(coalesced);
+        prevButton.setGeometryCoalesced(coalesced);
+        slider.setGeometryCoalesced(coalesced);
+        label.setGeometryCoalesced(coalesced);
+        slider.value.setCoalesced(coalesced);
+
+        nextButton.geometry = [&]() { ++evaluations;
+            return QRect(QPoint(geometry().width() - margin - nextButton.sizeHint().width(), margin),
+                         nextButton.sizeHint()); };
+        prevButton.geometry = [&]() { ++evaluations;
+            return QRect(QPoint(nextButton.geometry().x() - prevButton.sizeHint().width() - margin, margin),
+                         prevButton.sizeHint()); };
+        slider.geometry = [&]() { ++evaluations;
+            return QRect(margin, margin, prevButton.geometry().left() - 2 * margin, 20); };
+        label.geometry = [&]() { ++evaluations;
+            return QRect(margin, slider.geometry().bottom() + margin, geometry().width() - 2 * margin, 20); };
+        content.geometry = [&]() { ++evaluations;
+            int y = label.geometry().bottom() + margin;
+            return QRect(margin, y, geometry().width() - 2 * margin, geometry().height() - y - margin); };
+        label.text = [&]() { ++evaluations; return QString::number(slider.value()); };
+    }
+};
+
+static void run(bool coalesced) {
+    Window window(coalesced);
+    window.slider.setRange(0, 1000);
+    window.resize(800, 600);
+    window.show();
+    QApplication::processEvents();
+
+    const int frames = 200, changesPerFrame = 10;
+    evaluations = 0;
+    double s = bench::seconds([&]{
+        for (int f = 0; f < frames; ++f) {
+            for (int c = 0; c < changesPerFrame; ++c) {
+                window.resize(800 + (f * changesPerFrame + c) % 400, 600);
+                window.slider.setValue((f * changesPerFrame + c) % 1000);
+            }
+            QApplication::processEvents();
+        }
+    });
+    std::string name = std::string("resize/") + (coalesced ? "coalesced" : "immediate");
+    bench::report(name + "/frame", s / frames * 1e6, "us");
+    bench::report(name + "/evaluations", double(evaluations) / frames, "bindings");
+    if (window.content.geometry().width() != window.width() - 2 * window.margin()
+            || window.label.text() != QString::number(window.slider.value()))
+        std::cerr << "wrong result" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    QApplication app(argc, argv);
+    run(false);
+    run(true);
+}
+
+// QT_QPA_PLATFORM=offscreen
+// c++ -std=c++11 -O2 -I../src -fPIC -I/usr/include/qt -lQt5Core -lQt5Gui -lQt5Widgets ./resize.cc
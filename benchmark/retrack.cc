@@ -0,0 +1,58 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* Re-evaluation of a binding that reads the same properties every time: the dependency
+   edges are kept, so the steady state does not allocate. */
+
+#include "property.h"
+#include "bench.h"
+#include "allocations.h"
+
+#include <memory>
+#include <vector>
+
+static void run(int dependencies) {
+  property<int> trigger = 0;
+  std::vector<std::unique_ptr<property<int>>> inputs;
+  for (int i = 0; i < dependencies; ++i)
+    inputs.emplace_back(new property<int>(i));
+  property<long> sum = [&]{
+    long s = trigger;
+    for (auto &p : inputs)
+      s += p->get();
+    return s;
+  };
+
+  const int writes = 100000;
+  std::size_t allocations = bench::allocationCount;
+  double s = bench::seconds([&]{
+    for (int i = 0; i < writes; ++i)
+      trigger = i;
+  });
+  std::string name = "retrack/dependencies:" + std::to_string(dependencies);
+  bench::report(name + "/allocations_per_evaluation", double(bench::allocationCount - allocations) / writes, "allocations");
+  bench::report(name + "/evaluation", s / writes * 1e9, "ns");
+}
+
+int main() {
+  for (int dependencies : { 1, 3, 10, 100 })
+    run(dependencies);
+}
+
+// c++ -std=c++11 -O2 -I../src ./retrack.cc
@@ -0,0 +1,19 @@
+# Runs the benchmarks and collects their results in one JSON Lines file.
+#   cmake -DBENCHMARKS=<executables separated by |> -DOUTPUT=<file> -P run.cmake
+
+string(REPLACE "|" ";" BENCHMARKS "${BENCHMARKS}")
+set(ENV{BENCH_FORMAT} json)
+# For the benchmarks creating widgets
+set(ENV{QT_QPA_PLATFORM} offscreen)
+
+file(WRITE "${OUTPUT}" "")
+foreach(benchmark ${BENCHMARKS})
+  get_filename_component(name "${benchmark}" NAME_WE)
+  message(STATUS "Running ${name}")
+  execute_process(COMMAND "${benchmark}" OUTPUT_VARIABLE results RESULT_VARIABLE status)
+  if(NOT status EQUAL 0)
+    message(SEND_ERROR "${name} failed: ${status}")
+  endif()
+  file(APPEND "${OUTPUT}" "${results}")
+endforeach()
+message(STATUS "Results written to ${OUTPUT}")
@@ -0,0 +1,76 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* A source with a wide fan-out of CPU-heavy bindings, joined by a sum, evaluated
+   sequentially and with the work stealing scheduler on 1 to N threads. */
+
+#define PROPERTY_THREAD_SAFE
+#include "property.h"
+#include "property_scheduler.h"
+#include "bench.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+static double heavy(int seed, int i) {
+  double x = seed + i;
+  for (int k = 0; k < 2000; ++k)
+    x = std::sqrt(x * x + k);
+  return x;
+}
+
+static void run(int width, unsigned threads) {
+  property<int> source = 0;
+  std::vector<std::unique_ptr<property<double>>> fanOut;
+  for (int i = 0; i < width; ++i)
+    fanOut.emplace_back(new property<double>([&source, i]{ return heavy(source, i); }));
+  property<double> sum = [&]{
+    double s = 0;
+    for (auto &p : fanOut)
+      s += p->get();
+    return s;
+  };
+
+  std::unique_ptr<work_stealing_scheduler> scheduler;
+  if (threads) {
+    scheduler.reset(new work_stealing_scheduler(threads));
+    property_base::setScheduler(scheduler.get());
+  }
+  const int writes = 20;
+  double s = bench::seconds([&]{
+    for (int i = 0; i < writes; ++i)
+      source = i;
+  });
+  property_base::setScheduler(nullptr);
+  std::string name = "fan_out/width:" + std::to_string(width) + "/" +
+      (threads ? "threads:" + std::to_string(threads) : std::string("sequential"));
+  bench::report(name + "/write", s / writes * 1e6, "us");
+}
+
+int main() {
+  unsigned maxThreads = std::max(4u, std::thread::hardware_concurrency());
+  for (int width : { 16, 256 }) {
+    run(width, 0);
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+      run(width, threads);
+  }
+}
+
+// c++ -std=c++11 -O2 -pthread -I../src ./scheduler.cc
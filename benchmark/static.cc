@@ -0,0 +1,78 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* The rectangle of test/test.cc updated with hand-written code, with a static_graph and
+   with dynamic properties. */
+
+#include "property.h"
+#include "static_property.h"
+#include "bench.h"
+
+static int calculateArea(int width, int height) {
+  return (width * height) * 0.5;
+}
+
+struct hand_written {
+  int width = 150, height = 75, area, perimeter, ratio;
+  hand_written() { update(); }
+  void setWidth(int w) { width = w; update(); }
+  void update() {
+    area = calculateArea(width, height);
+    perimeter = 2 * (width + height);
+    ratio = area / (perimeter + 1);
+  }
+};
+
+struct dynamic_rectangle {
+  property<int> width = 150;
+  property<int> height = 75;
+  property<int> area = [&]{ return calculateArea(width, height); };
+  property<int> perimeter = [&]{ return 2 * (width + height); };
+  property<int> ratio = [&]{ return area / (perimeter + 1); };
+};
+
+template <typename F> static void run(const char *kind, F write) {
+  const int writes = 1000000;
+  long sum = 0;
+  double s = bench::seconds([&]{
+    for (int i = 0; i < writes; ++i)
+      sum += write(i);
+  });
+  bench::report(std::string("rectangle/") + kind + "/write", s / writes * 1e9, "ns");
+  if (sum == 42)
+    std::cerr << sum;
+}
+
+int main() {
+  hand_written h;
+  run("hand_written", [&](int i) { h.setWidth(i & 0xff); return h.ratio; });
+
+  auto g = make_static_graph(
+      static_source<int>(150),
+      static_source<int>(75),
+      static_bind<int, 0, 1>([](int w, int h) { return calculateArea(w, h); }),
+      static_bind<int, 0, 1>([](int w, int h) { return 2 * (w + h); }),
+      static_bind<int, 2, 3>([](int a, int p) { return a / (p + 1); }));
+  run("static_graph", [&](int i) { g.set<0>(i & 0xff); return g.get<4>(); });
+
+  dynamic_rectangle d;
+  run("property", [&](int i) { d.width = i & 0xff; return d.ratio.get(); });
+}
+
+// c++ -std=c++11 -O2 -I../src ./static.cc
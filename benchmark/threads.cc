@@ -0,0 +1,61 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* Independent graphs updated from 1 to N threads. Every graph also depends on a property
+   shared by all the threads, whose subscriber list is therefore locked concurrently. */
+
+#define PROPERTY_THREAD_SAFE
+#include "property.h"
+#include "bench.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+property<int> shared = 1;
+
+static void worker(int writes) {
+  property<int> source = 0;
+  std::vector<std::unique_ptr<property<int>>> chain;
+  property<int> *previous = &source;
+  for (int i = 0; i < 20; ++i) {
+    chain.emplace_back(new property<int>([previous]{ return previous->get() + shared; }));
+    previous = chain.back().get();
+  }
+  for (int i = 0; i < writes; ++i)
+    source = i;
+}
+
+int main() {
+  const int writesPerThread = 50000;
+  unsigned maxThreads = std::max(4u, std::thread::hardware_concurrency());
+  for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+    double s = bench::seconds([&]{
+      std::vector<std::thread> pool;
+      for (unsigned t = 0; t < threads; ++t)
+        pool.emplace_back(worker, writesPerThread);
+      for (std::thread &t : pool)
+        t.join();
+    });
+    std::string name = "independent_graphs/threads:" + std::to_string(threads);
+    bench::report(name + "/throughput", threads * writesPerThread / s, "writes/s");
+  }
+}
+
+// c++ -std=c++11 -O2 -pthread -I../src ./threads.cc
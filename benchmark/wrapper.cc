@@ -0,0 +1,98 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* The layout of the browser example, with the widgets replaced by plain structs: each
+   geometry is a property_wrapper whose getter counts how often it is called, and whose setter
+   notifies the wrapper like a Resize event would.  The window is resized many times and we
+   report the time and the number of getter calls for one layout pass, with and without the
+   cached mode of property_wrapper. */
+
+#include "property.h"
+#include "bench.h"
+
+#include <memory>
+#include <vector>
+
+struct rect {
+  int x, y, width, height;
+  int right() const { return x + width; }
+  int bottom() const { return y + height; }
+  bool operator!=(const rect &o) const { return x != o.x || y != o.y || width != o.width || height != o.height; }
+};
+
+static long reads = 0;
+
+struct widget {
+  rect r = rect{ 0, 0, 0, 0 };
+  property_wrapper<rect> geometry{
+    [this](const rect &n) { if (n != r) { r = n; geometry.notify(); } },
+    [this]() { ++reads; return r; } };
+};
+
+static void run(int buttons, bool cached) {
+  const int margin = 10, buttonHeight = 20;
+  widget window, urlBar, webview;
+  std::vector<std::unique_ptr<widget>> toolbar;
+  for (int i = 0; i < buttons; ++i)
+    toolbar.emplace_back(new widget);
+  window.geometry.setCached(cached);
+  urlBar.geometry.setCached(cached);
+  webview.geometry.setCached(cached);
+  for (auto &b : toolbar)
+    b->geometry.setCached(cached);
+
+  widget *previous = nullptr;
+  for (auto &b : toolbar) {
+    widget *w = b.get();
+    w->geometry = [&window, previous, buttons]() {
+      int left = previous ? previous->geometry().right() + margin : window.geometry().width / 2;
+      return rect{ left, margin, (window.geometry().width / 2 - margin) / buttons - margin, buttonHeight };
+    };
+    previous = w;
+  }
+  widget *first = toolbar.front().get();
+  urlBar.geometry = [&]() {
+    return rect{ margin, margin, first->geometry().x - 2 * margin, buttonHeight };
+  };
+  webview.geometry = [&]() {
+    int y = urlBar.geometry().bottom() + margin;
+    return rect{ margin, y, window.geometry().width - 2 * margin, window.geometry().height - y - margin };
+  };
+
+  const int passes = 10000;
+  long before = reads;
+  double s = bench::seconds([&]{
+    for (int i = 0; i < passes; ++i)
+      window.geometry = rect{ 0, 0, 800 + i % 400, 600 + i % 300 };
+  });
+  std::string name = std::string("layout/") + (cached ? "cached" : "uncached") + "/buttons:" + std::to_string(buttons);
+  bench::report(name + "/pass", s / passes * 1e9, "ns");
+  bench::report(name + "/reads", double(reads - before) / passes, "calls");
+  if (webview.geometry().width != 800 + (passes - 1) % 400 - 2 * margin)
+    std::cerr << "wrong result" << std::endl;
+}
+
+int main() {
+  for (int buttons : { 2, 10, 50 }) {
+    run(buttons, false);
+    run(buttons, true);
+  }
+}
+
+// c++ -std=c++11 -O2 -I../src ./wrapper.cc
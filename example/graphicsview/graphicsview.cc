@@ -74,13 +74,16 @@ struct MyWindow : Widget {
         return QRect(margin, x, width() - 2*margin, geometry().height() - x - margin); 
     };
 
-    // Some proper default value
-    colorEdit.text = QString("blue");
-    rotationSlider.minimum = -180;
-    rotationSlider.maximum = 180;
-    opacitySlider.minimum = 0;
-    opacitySlider.maximum = 100;
-    opacitySlider.value = 100;
+    // Some proper default value, the bindings are re-evaluated once at the end of the batch
+    {
+      property_base::batch b;
+      colorEdit.text = QString("blue");
+      rotationSlider.minimum = -180;
+      rotationSlider.maximum = 180;
+      opacitySlider.minimum = 0;
+      opacitySlider.maximum = 100;
+      opacitySlider.value = 100;
+    }
 
     scene.addItem(&rectangle);
 
@@ -18,99 +18,1056 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 #pragma once
-#include <functional>
-#include <unordered_set>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <thread>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "property_function.h"
+
+#ifdef PROPERTY_INSTRUMENTATION
+#include <chrono>
+#include <mutex>
+#endif
+
+/** Allocates the bookkeeping of the dependency graph: its edges, which all have the same size.
+    Set it with property_base::setAllocator() */
+struct property_allocator {
+  virtual ~property_allocator() {}
+  virtual void *allocate(std::size_t size) = 0;
+  virtual void deallocate(void *p, std::size_t size) = 0;
+};
+
+/** An allocator of blocks of a fixed size, taken from chunks of blocksPerChunk blocks.
+    The freed blocks are reused and the chunks are only released when the pool is destroyed,
+    so a graph is built and torn down with a handful of calls to the system allocator.
+    The pool is shared by the graphs of all the threads, so it is always locked, also without
+    PROPERTY_THREAD_SAFE. */
+class property_pool : public property_allocator {
+  struct block { block *next; };
+  // Chunks are linked through their first block
+  block *chunks = nullptr;
+  block *freeList = nullptr;
+  std::size_t blocksPerChunk;
+  std::size_t blockSize = 0;
+  std::atomic_flag lock = ATOMIC_FLAG_INIT;
+  void acquire() { while (lock.test_and_set(std::memory_order_acquire)) std::this_thread::yield(); }
+  void release() { lock.clear(std::memory_order_release); }
+
+public:
+  explicit property_pool(std::size_t n = 1024) : blocksPerChunk(n) {}
+  property_pool(const property_pool &) = delete;
+  property_pool &operator=(const property_pool &) = delete;
+  ~property_pool() {
+    while (chunks) {
+      block *next = chunks->next;
+      ::operator delete(chunks);
+      chunks = next;
+    }
+  }
+
+  void *allocate(std::size_t size) override {
+    acquire();
+    if (!blockSize)
+      blockSize = (std::max(size, sizeof(block)) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+    if (!freeList) {
+      char *chunk = static_cast<char *>(::operator new(blockSize * (blocksPerChunk + 1)));
+      reinterpret_cast<block *>(chunk)->next = chunks;
+      chunks = reinterpret_cast<block *>(chunk);
+      for (std::size_t i = blocksPerChunk; i > 0; --i) {
+        block *b = reinterpret_cast<block *>(chunk + i * blockSize);
+        b->next = freeList;
+        freeList = b;
+      }
+    }
+    block *b = freeList;
+    freeList = b->next;
+    release();
+    return b;
+  }
+
+  void deallocate(void *p, std::size_t) override {
+    acquire();
+    block *b = static_cast<block *>(p);
+    b->next = freeList;
+    freeList = b;
+    release();
+  }
+};
+
+#ifdef PROPERTY_INSTRUMENTATION
+/** What is recorded for every property when PROPERTY_INSTRUMENTATION is defined.
+    See property_instrumentation.h to dump them with the graph. */
+struct property_statistics {
+  const char *name;
+  // Evaluations of the binding, and the time spent in them, including nested evaluations
+  unsigned long evaluations;
+  std::chrono::nanoseconds time;
+  unsigned long notifications;
+};
+#endif
+
+#ifdef PROPERTY_RECORDING
+class property_base;
+
+/** Receives the changes of the graph when PROPERTY_RECORDING is defined and a recorder is
+    set with property_base::setRecorder(). See property_recorder.h.
+    'propagating' tells whether the change happens while a propagation evaluates the
+    properties, rather than being made by the application. */
+struct property_recorder {
+  virtual ~property_recorder() {}
+  virtual void created(const property_base *p) = 0;
+  virtual void destroyed(const property_base *p) = 0;
+  // The dependencies of p changed, they can be read with forEachDependency()
+  virtual void dependenciesChanged(const property_base *p, bool propagating) = 0;
+  // The application changed p, or notified a change of it
+  virtual void written(const property_base *p) = 0;
+  virtual void batchBegin() = 0;
+  virtual void batchEnd() = 0;
+  // p was evaluated during a propagation but its value did not change
+  virtual void cutoff(const property_base *p) = 0;
+};
+#endif
+
+/* The property being evaluated and the propagation queue are per thread, so independent
+   graphs can be evaluated in parallel from different threads.
+   When PROPERTY_THREAD_SAFE is defined, the subscriber lists are also protected by a lock, so
+   bindings evaluated in different threads can depend on the same property. The value of a
+   property must still not be written while it is read from another thread. */
 class property_base
 {
-  /* Set of properties which are subscribed to this one.
+  /* An edge of the dependency graph: 'target' depends on 'source'.
+     It is linked both in the subscribers of the source and in the dependencies of the target,
+     so it can be removed from both lists in constant time. */
+  struct edge {
+    property_base *source;
+    property_base *target;
+    edge *prevSubscriber, *nextSubscriber;
+    edge *prevDependency, *nextDependency;
+    /* While the target is evaluated: the previous value of source->trackingEdge, and whether
+       the binding accessed the source again. */
+    edge *rollback;
+    bool used;
+    // Closes a cycle: the source is higher than the target, and height raises do not follow it
+    bool back;
+  };
+
+  /* List of properties which are subscribed to this one.
      When this property is changed, subscriptions are refreshed */
-  std::unordered_set<property_base *> subscribers;
+  edge *subscribers = nullptr;
+
+  /* List of properties this property is depending on, in the order they were accessed. */
+  edge *dependencies = nullptr;
 
-  /* Set of properties this property is depending on. */
-  std::unordered_set<property_base *> dependencies;
+#ifdef PROPERTY_THREAD_SAFE
+  // Protects the subscriber list, which is modified by the threads evaluating the subscribers
+  mutable std::atomic_flag subscribersLock = ATOMIC_FLAG_INIT;
+  typedef std::atomic<unsigned> height_t;
+  typedef std::atomic<bool> flag_t;
+#else
+  /* While properties depending on this one are being evaluated, the edge to the innermost of
+     them. It lets accessed() find an existing dependency without searching. */
+  edge *trackingEdge = nullptr;
+  typedef unsigned height_t;
+  typedef bool flag_t;
+#endif
+
+  /* Upper bound of the length of the longest chain of dependencies of this property.
+     It is always bigger than the height of every dependency, so evaluating the scheduled
+     properties by increasing height evaluates each of them after all its inputs. */
+  height_t height{0};
+
+  /* Set while this property waits in the propagation queue. */
+  flag_t scheduled{false};
+
+  /* Set on the target of a back edge: its evaluations are limited by the cycle policy. */
+  flag_t cyclic{false};
+
+#ifdef PROPERTY_INSTRUMENTATION
+  property_statistics stats{nullptr, 0, std::chrono::nanoseconds(0), 0};
+  // Links all the live properties
+  property_base *prevInstance = nullptr, *nextInstance = nullptr;
+#endif
 
 public:
   virtual ~property_base()
-  { clearSubscribers(); clearDependencies(); }
+  {
+    if (cyclic) queue().forgetCyclic(this);
+#ifdef PROPERTY_RECORDING
+    // Their dependencies change too
+    std::vector<property_base *> subscribed;
+    if (recorder()) {
+      subscribers_guard guard(this);
+      for (edge *e = subscribers; e; e = e->nextSubscriber)
+        subscribed.push_back(e->target);
+    }
+#endif
+    clearSubscribers(); clearDependencies();
+    if (scheduled) queue().remove(this);
+#ifdef PROPERTY_RECORDING
+    if (property_recorder *r = recorder()) {
+      for (property_base *p : subscribed)
+        r->dependenciesChanged(p, queue().propagating());
+      r->destroyed(this);
+    }
+#endif
+#ifdef PROPERTY_INSTRUMENTATION
+    std::lock_guard<std::mutex> lock(instancesMutex());
+    (prevInstance ? prevInstance->nextInstance : instances()) = nextInstance;
+    if (nextInstance)
+      nextInstance->prevInstance = prevInstance;
+#endif
+  }
 
   // re-evaluate this property
   virtual void evaluate() = 0;
 
+#if defined(PROPERTY_INSTRUMENTATION) || defined(PROPERTY_RECORDING)
+  property_base() { added(); }
+#else
   property_base() = default;
-  property_base(const property_base &other) : dependencies(other.dependencies) {
-    for (property_base *p : dependencies)
-      p->subscribers.insert(this);
+#endif
+  property_base(const property_base &other) : height(unsigned(other.height)) {
+    edge *last = nullptr;
+    for (edge *e = other.dependencies; e; e = e->nextDependency)
+      last = link(e->source, this, last);
+#if defined(PROPERTY_INSTRUMENTATION) || defined(PROPERTY_RECORDING)
+    added();
+#endif
+  }
+  /* Takes the dependencies of 'other' instead of its own, like the copy constructor.
+     The subscribers of this property stay, and are not notified. */
+  property_base &operator=(const property_base &other) {
+    if (this == &other)
+      return *this;
+    clearDependencies();
+    edge *last = nullptr;
+    for (edge *e = other.dependencies; e; e = e->nextDependency) {
+      if (e->source != this)
+        last = link(e->source, this, last);
+    }
+    for (edge *e = dependencies; e; e = e->nextDependency) {
+      if (height <= e->source->height)
+        raiseHeight(e->source->height + 1, this);
+    }
+    // The raises find the dependencies closing a cycle, as in accessed()
+    for (edge *e = dependencies; e;) {
+      edge *next = e->nextDependency;
+      if (e->back) {
+        ++cycleStatistics().cycles;
+        if (cycleSettings().policy == cycle_policy::reject)
+          unlink(e);
+        else
+          cyclic = true;
+      }
+      e = next;
+    }
+#ifdef PROPERTY_RECORDING
+    if (property_recorder *r = recorder()) {
+      if (dependencies)
+        r->dependenciesChanged(this, queue().propagating());
+    }
+#endif
+    return *this;
+  }
+
+  // Calls f with each property this one depends on, in the order they were accessed
+  template<typename F> void forEachDependency(F f) const {
+    for (edge *e = dependencies; e; e = e->nextDependency)
+      f(e->source);
+  }
+
+  /* Names the property in the output of the instrumentation. The string is not copied.
+     Does nothing unless PROPERTY_INSTRUMENTATION is defined. */
+  void setName(const char *name) {
+#ifdef PROPERTY_INSTRUMENTATION
+    stats.name = name;
+#else
+    (void)name;
+#endif
+  }
+
+#ifdef PROPERTY_INSTRUMENTATION
+  const property_statistics &statistics() const { return stats; }
+  // Number of properties this one depends on, and number of properties depending on it
+  std::size_t fanIn() const {
+    std::size_t n = 0;
+    for (edge *e = dependencies; e; e = e->nextDependency)
+      ++n;
+    return n;
+  }
+  std::size_t fanOut() const {
+    std::size_t n = 0;
+    subscribers_guard guard(this);
+    for (edge *e = subscribers; e; e = e->nextSubscriber)
+      ++n;
+    return n;
+  }
+  // Upper bound of the length of the longest chain of dependencies leading to this property
+  unsigned depth() const { return height; }
+
+  /* Calls f on every live property. Properties must not be created or destroyed meanwhile,
+     and the graph must not change. */
+  template<typename F> static void forEachInstance(F f) {
+    std::lock_guard<std::mutex> lock(instancesMutex());
+    for (property_base *p = instances(); p; p = p->nextInstance)
+      f(p);
+  }
+  static void resetStatistics() {
+    forEachInstance([](property_base *p) {
+      p->stats = property_statistics{p->stats.name, 0, std::chrono::nanoseconds(0), 0};
+    });
+  }
+#endif
+
+  /* Helper class that is used on the stack to group several changes.
+     The properties depending on them are only re-evaluated when the outermost batch is
+     destroyed, once each. Until then, the bindings keep their old value. */
+  struct batch {
+    batch() {
+#ifdef PROPERTY_RECORDING
+      if (property_recorder *r = recorder())
+        r->batchBegin();
+#endif
+      ++queue().batches;
+    }
+    // Propagates the exception of a binding evaluated when the outermost batch ends
+    ~batch() noexcept(false) {
+#ifdef PROPERTY_RECORDING
+      if (property_recorder *r = recorder())
+        r->batchEnd();
+#endif
+      propagation_queue &q = queue();
+      if (--q.batches == 0)
+        q.run();
+    }
+    batch(const batch &) = delete;
+    batch &operator=(const batch &) = delete;
+  };
+
+  /* Counts the changes that were not propagated because the new value was equal to the
+     previous one, and the subscribers that were not re-evaluated because of that.
+     The statistics are those of the calling thread. */
+  struct cutoff_statistics {
+    unsigned long cutoffs;
+    unsigned long skippedSubscribers;
+  };
+  static cutoff_statistics &cutoffStatistics() { static thread_local cutoff_statistics s{0, 0}; return s; }
+
+  /* What to do when a binding accesses a property which depends on it, directly or not.
+     reject: the dependency closing the cycle is not recorded, so the binding is not
+       re-evaluated when that property changes.
+     break_after_one_pass: the property whose new dependency closed the cycle is evaluated at
+       most once per propagation, so the propagation goes around the cycle once.
+     fixed_point: that property is evaluated at most 'maxIterations' times per propagation.
+       Use it with setEqualityCutoff(), so the propagation stops once the values are stable.
+     Cycles are found when the heights are raised for a new dependency, and limited when the
+     queue is run, so graphs without cycles do not pay for it. */
+  enum class cycle_policy { reject, break_after_one_pass, fixed_point };
+  static void setCyclePolicy(cycle_policy p, unsigned maxIterations = 100) {
+    cycleSettings().policy = p;
+    cycleSettings().maxIterations = p == cycle_policy::fixed_point ? maxIterations : 1;
+  }
+
+  /* Counts the dependencies which closed a cycle, and the evaluations skipped because of the
+     cycle policy. The statistics are those of the calling thread. */
+  struct cycle_statistics {
+    unsigned long cycles;
+    unsigned long truncated;
+  };
+  static cycle_statistics &cycleStatistics() { static thread_local cycle_statistics s{0, 0}; return s; }
+
+  /* Sets the allocator of the edges of the graph, and returns the previous one.
+     The default is a property_pool shared by all threads. An edge is released to the
+     allocator in use at that time, so only change it while no property has dependencies. */
+  static property_allocator *setAllocator(property_allocator *a) {
+    property_allocator *previous = allocator();
+    allocator() = a;
+    return previous;
+  }
+
+#ifdef PROPERTY_RECORDING
+  /* Sets the recorder receiving the changes of the graph from all threads, and returns the
+     previous one. Set it while no property is being evaluated. */
+  static property_recorder *setRecorder(property_recorder *r) {
+    property_recorder *previous = recorder();
+    recorder() = r;
+    return previous;
+  }
+#endif
+
+  /* A scheduler evaluates at once all the scheduled properties of the same height. They do
+     not depend on each other, so it may evaluate them in parallel, with evaluateDetached().
+     Setting a scheduler requires PROPERTY_THREAD_SAFE if it uses other threads. */
+  struct propagation_scheduler {
+    virtual ~propagation_scheduler() {}
+    /* Evaluates the properties of 'level', and appends to 'notified' the properties that
+       they scheduled in turn. */
+    virtual void evaluateLevel(const std::vector<property_base *> &level,
+                               std::vector<property_base *> &notified) = 0;
+  };
+  // Sets the scheduler used by the propagations started from the calling thread
+  static void setScheduler(propagation_scheduler *s) { queue().scheduler = s; }
+
+  /* Evaluates a property on behalf of a propagation running in another thread.
+     The properties it notifies are not evaluated but appended to 'notified'.
+     If the binding throws, the properties it notified are dropped. */
+  static void evaluateDetached(property_base *prop, std::vector<property_base *> &notified) {
+    propagation_queue &q = queue();
+    struct detached_guard {
+      propagation_queue &q;
+      explicit detached_guard(propagation_queue &q) : q(q) {
+        ++q.batches;
+#ifdef PROPERTY_RECORDING
+        q.detached = true;
+#endif
+      }
+      ~detached_guard() {
+#ifdef PROPERTY_RECORDING
+        q.detached = false;
+#endif
+        --q.batches;
+        // Otherwise the run of this thread drops them
+        if (q.count && !q.running)
+          q.drop();
+      }
+    };
+    {
+      detached_guard guard(q);
+      prop->evaluate();
+      q.takeAll(notified);
+    }
   }
 
 protected:
   /* This function is called by the derived class when the property has changed
-     The default implementation re-evaluates all the property subscribed to this one. */
+     The default implementation schedules all the properties subscribed to this one for
+     re-evaluation. They are not evaluated recursively: the outermost notify() evaluates the
+     scheduled properties by increasing height, so a property reachable through several paths
+     is evaluated only once, and only after all its dependencies got their new value.
+     Scheduling runs no user code, so the subscribers cannot change while they are walked and
+     the list does not need to be copied. */
   virtual void notify() {
-    auto copy = subscribers;
-    for (property_base *p : copy) {
-      p->evaluate();
+#ifdef PROPERTY_INSTRUMENTATION
+    ++stats.notifications;
+#endif
+    propagation_queue &q = queue();
+#ifdef PROPERTY_RECORDING
+    if (property_recorder *r = recorder()) {
+      if (!q.propagating())
+        r->written(this);
     }
+#endif
+    {
+      subscribers_guard guard(this);
+      for (edge *e = subscribers; e; e = e->nextSubscriber)
+        q.schedule(e->target);
+    }
+    q.run();
   }
 
   /* Derived class call this function whenever this property is accessed.
-     It register the dependencies. */
+     It register the dependencies. When the binding accesses the same properties in the same
+     order as on its previous evaluation, the existing edges are kept as they are. */
   void accessed() {
-    if (current && current != this) {
-      subscribers.insert(current);
-      current->dependencies.insert(this);
+    evaluation_scope *scope = current();
+    if (!scope || scope->prop == this)
+      return;
+    edge *next = scope->last ? scope->last->nextDependency : scope->prop->dependencies;
+    if (next && next->source == this) {
+      // Same order as the previous evaluation
+      next->used = true;
+      scope->last = next;
+      return;
+    }
+    edge *e = findDependency(scope->prop);
+    if (e) {
+      if (e->used)
+        return;
+      e->used = true;
+      moveDependency(e, scope->last);
+      scope->last = e;
+#ifdef PROPERTY_RECORDING
+      scope->changed = true;
+#endif
+      return;
+    }
+    e = link(this, scope->prop, scope->last);
+    e->used = true;
+#ifdef PROPERTY_RECORDING
+    scope->changed = true;
+#endif
+#ifndef PROPERTY_THREAD_SAFE
+    e->rollback = trackingEdge;
+    trackingEdge = e;
+#endif
+    scope->last = e;
+    if (scope->prop->height <= height) {
+      scope->prop->raiseHeight(height + 1, scope->prop);
+      if (e->back)
+        closeCycle(e, scope);
+    }
+  }
+
+  /* Called by the derived class instead of notify() when the value did not change. */
+  void cutoff() {
+#ifdef PROPERTY_RECORDING
+    if (property_recorder *r = recorder()) {
+      if (queue().propagating())
+        r->cutoff(this);
     }
+#endif
+    cutoff_statistics &s = cutoffStatistics();
+    ++s.cutoffs;
+    subscribers_guard guard(this);
+    for (edge *e = subscribers; e; e = e->nextSubscriber)
+      ++s.skippedSubscribers;
   }
 
   void clearSubscribers() {
-      for (property_base *p : subscribers)
-          p->dependencies.erase(this);
-      subscribers.clear();
+      edge *e;
+      while ((e = firstSubscriber()))
+          unlink(e);
   }
   void clearDependencies() {
-      for (property_base *p : dependencies)
-          p->subscribers.erase(this);
-      dependencies.clear();
+#ifdef PROPERTY_RECORDING
+      bool had = dependencies;
+#endif
+      while (dependencies)
+          unlink(dependencies);
+      cyclic = false;
+#ifdef PROPERTY_RECORDING
+      if (property_recorder *r = recorder()) {
+        if (had)
+          r->dependenciesChanged(this, queue().propagating());
+      }
+#endif
   }
 
-  /* Helper class that is used on the stack to set the current property being evaluated */
+  /* Helper class that is used on the stack to set the current property being evaluated.
+     The dependencies that were not accessed while it was alive are removed when it ends. */
   struct evaluation_scope {
-    evaluation_scope(property_base *prop) : previous(current) {
-      current = prop;
+    evaluation_scope(property_base *p) : prop(p), previous(current()) {
+#ifndef PROPERTY_THREAD_SAFE
+      for (edge *e = prop->dependencies; e; e = e->nextDependency) {
+        e->rollback = e->source->trackingEdge;
+        e->source->trackingEdge = e;
+      }
+#endif
+      current() = this;
+#ifdef PROPERTY_INSTRUMENTATION
+      start = std::chrono::steady_clock::now();
+#endif
+    }
+    ~evaluation_scope() {
+#ifdef PROPERTY_INSTRUMENTATION
+      ++prop->stats.evaluations;
+      prop->stats.time += std::chrono::steady_clock::now() - start;
+#endif
+      edge *e = last ? last->nextDependency : prop->dependencies;
+      while (e) {
+        edge *next = e->nextDependency;
+#ifndef PROPERTY_THREAD_SAFE
+        e->source->trackingEdge = e->rollback;
+#endif
+        unlink(e);
+        e = next;
+#ifdef PROPERTY_RECORDING
+        changed = true;
+#endif
+      }
+      for (e = prop->dependencies; e; e = e->nextDependency) {
+        e->used = false;
+#ifndef PROPERTY_THREAD_SAFE
+        e->source->trackingEdge = e->rollback;
+#endif
+      }
+      if (prop->cyclic)
+        prop->recheckCycles();
+#ifdef PROPERTY_RECORDING
+      if (property_recorder *r = recorder()) {
+        if (changed)
+          r->dependenciesChanged(prop, queue().propagating());
+      }
+#endif
+      current() = previous;
     }
-    ~evaluation_scope() { current = previous; }
-    property_base *previous;
+    property_base *prop;
+    evaluation_scope *previous;
+    // The last dependency accessed so far
+    edge *last = nullptr;
+#ifdef PROPERTY_INSTRUMENTATION
+    std::chrono::steady_clock::time_point start;
+#endif
+#ifdef PROPERTY_RECORDING
+    // Whether the dependencies differ from those of the previous evaluation
+    bool changed = false;
+#endif
   };
 private:
   friend struct evaluation_scope;
-  /* thread_local */ static property_base *current;
+  static evaluation_scope *&current() { static thread_local evaluation_scope *scope = nullptr; return scope; }
+
+  /* Locks the subscriber list of a property when PROPERTY_THREAD_SAFE is defined.
+     Locks are taken one at a time, or from a source to its subscribers. */
+  struct subscribers_guard {
+#ifdef PROPERTY_THREAD_SAFE
+    explicit subscribers_guard(const property_base *p) : lock(p->subscribersLock) {
+      while (lock.test_and_set(std::memory_order_acquire))
+        std::this_thread::yield();
+    }
+    ~subscribers_guard() { lock.clear(std::memory_order_release); }
+    std::atomic_flag &lock;
+#else
+    explicit subscribers_guard(const property_base *) {}
+#endif
+  };
+
+  edge *firstSubscriber() const {
+    subscribers_guard guard(this);
+    return subscribers;
+  }
+
+  // The edge from this property to the target, if the target already depends on it
+  edge *findDependency(property_base *target) const {
+#ifdef PROPERTY_THREAD_SAFE
+    for (edge *e = target->dependencies; e; e = e->nextDependency) {
+      if (e->source == this)
+        return e;
+    }
+    return nullptr;
+#else
+    return trackingEdge && trackingEdge->target == target ? trackingEdge : nullptr;
+#endif
+  }
+
+  // Creates an edge, placed after 'after' in the dependencies of the target
+  static edge *link(property_base *source, property_base *target, edge *after) {
+    edge *e = new (allocator()->allocate(sizeof(edge))) edge{source, target, nullptr, nullptr, nullptr, nullptr, nullptr, false, false};
+    {
+      subscribers_guard guard(source);
+      e->nextSubscriber = source->subscribers;
+      if (source->subscribers)
+        source->subscribers->prevSubscriber = e;
+      source->subscribers = e;
+    }
+    insertDependency(e, after);
+    return e;
+  }
+
+  static void insertDependency(edge *e, edge *after) {
+    e->prevDependency = after;
+    e->nextDependency = after ? after->nextDependency : e->target->dependencies;
+    if (e->nextDependency)
+      e->nextDependency->prevDependency = e;
+    if (after)
+      after->nextDependency = e;
+    else
+      e->target->dependencies = e;
+  }
+
+  static void moveDependency(edge *e, edge *after) {
+    if (e->prevDependency)
+      e->prevDependency->nextDependency = e->nextDependency;
+    else
+      e->target->dependencies = e->nextDependency;
+    if (e->nextDependency)
+      e->nextDependency->prevDependency = e->prevDependency;
+    insertDependency(e, after);
+  }
+
+  static void unlink(edge *e) {
+    {
+      subscribers_guard guard(e->source);
+      if (e->prevSubscriber)
+        e->prevSubscriber->nextSubscriber = e->nextSubscriber;
+      else
+        e->source->subscribers = e->nextSubscriber;
+      if (e->nextSubscriber)
+        e->nextSubscriber->prevSubscriber = e->prevSubscriber;
+    }
+    if (e->prevDependency)
+      e->prevDependency->nextDependency = e->nextDependency;
+    else
+      e->target->dependencies = e->nextDependency;
+    if (e->nextDependency)
+      e->nextDependency->prevDependency = e->prevDependency;
+    // Accessed by a binding being evaluated: its source is destroyed while the binding runs
+    if (e->used) {
+      for (evaluation_scope *scope = current(); scope; scope = scope->previous) {
+        if (scope->last == e)
+          scope->last = e->prevDependency;
+      }
+    }
+    allocator()->deallocate(e, sizeof(edge));
+  }
+
+  static bool raise(unsigned &height, unsigned h) {
+    if (height >= h)
+      return false;
+    height = h;
+    return true;
+  }
+#ifdef PROPERTY_THREAD_SAFE
+  static bool raise(std::atomic<unsigned> &height, unsigned h) {
+    unsigned current = height.load();
+    while (current < h) {
+      if (height.compare_exchange_weak(current, h))
+        return true;
+    }
+    return false;
+  }
+#endif
+
+  /* Heights never decrease: a stale upper bound still gives a valid order.
+     Back edges are not followed, so without them the graph has no cycle, and a raise started
+     from 'root' only comes back to it through the new dependency of root closing a cycle. */
+  void raiseHeight(unsigned h, property_base *root) {
+    // Already raised at least as high by another thread, which raises the subscribers too
+    if (!raise(height, h))
+      return;
+    subscribers_guard guard(this);
+    for (edge *e = subscribers; e; e = e->nextSubscriber) {
+      if (e->back || e->target->height > h)
+        continue;
+      if (e->target == root)
+        e->back = true;
+      else
+        e->target->raiseHeight(h + 1, root);
+    }
+  }
+
+  // Whether 'to' depends on this property through edges that are not back edges
+  bool reaches(const property_base *to) const {
+    // Heights increase along these edges, so the search stops at the height of 'to'
+    std::vector<const property_base *> stack(1, this), visited;
+    while (!stack.empty()) {
+      const property_base *p = stack.back();
+      stack.pop_back();
+      subscribers_guard guard(p);
+      for (edge *e = p->subscribers; e; e = e->nextSubscriber) {
+        const property_base *t = e->target;
+        if (t == to && !e->back)
+          return true;
+        if (e->back || t->height >= to->height
+            || std::find(visited.begin(), visited.end(), t) != visited.end())
+          continue;
+        visited.push_back(t);
+        stack.push_back(t);
+      }
+    }
+    return false;
+  }
+
+  /* Called after an evaluation of a cyclic property: the back edges into it whose cycle is
+     gone become normal edges again, with the height raised above their source, and the
+     property is no longer cyclic once it has no back edge left. */
+  void recheckCycles() {
+    for (edge *e = dependencies; e; e = e->nextDependency) {
+      if (!e->back || reaches(e->source))
+        continue;
+      e->back = false;
+      if (height <= e->source->height)
+        raiseHeight(e->source->height + 1, this);
+    }
+    bool back = false;
+    for (edge *e = dependencies; e && !back; e = e->nextDependency)
+      back = e->back;
+    cyclic = back;
+  }
+
+  // Applies the cycle policy to 'e', the edge just created by accessed() in 'scope'
+  void closeCycle(edge *e, evaluation_scope *scope) {
+    ++cycleStatistics().cycles;
+    if (cycleSettings().policy != cycle_policy::reject) {
+      scope->prop->cyclic = true;
+      return;
+    }
+#ifndef PROPERTY_THREAD_SAFE
+    trackingEdge = e->rollback;
+#endif
+    scope->last = e->prevDependency;
+    unlink(e);
+  }
+
+#if defined(PROPERTY_INSTRUMENTATION) || defined(PROPERTY_RECORDING)
+  void added() {
+#ifdef PROPERTY_INSTRUMENTATION
+    {
+      std::lock_guard<std::mutex> lock(instancesMutex());
+      nextInstance = instances();
+      if (nextInstance)
+        nextInstance->prevInstance = this;
+      instances() = this;
+    }
+#endif
+#ifdef PROPERTY_RECORDING
+    if (property_recorder *r = recorder()) {
+      r->created(this);
+      if (dependencies)
+        r->dependenciesChanged(this, queue().propagating());
+    }
+#endif
+  }
+#endif
+
+#ifdef PROPERTY_RECORDING
+  static property_recorder *&recorder() { static property_recorder *r = nullptr; return r; }
+#endif
+
+#ifdef PROPERTY_INSTRUMENTATION
+  static property_base *&instances() { static property_base *first = nullptr; return first; }
+  // Never destroyed, like the allocator
+  static std::mutex &instancesMutex() { static std::mutex *m = new std::mutex; return *m; }
+#endif
+
+  struct cycle_settings {
+    cycle_policy policy;
+    unsigned maxIterations;
+  };
+  static cycle_settings &cycleSettings() {
+    static cycle_settings s{cycle_policy::break_after_one_pass, 1};
+    return s;
+  }
+
+  /* The properties waiting to be re-evaluated, in one bucket per height. Scheduling is a
+     push_back and the buckets are evaluated by increasing height. A property whose height was
+     raised after it was scheduled is moved to its new bucket when it is reached. */
+  struct propagation_queue {
+    std::vector<std::vector<property_base *>> buckets;
+    // All the entries are in this bucket or above
+    std::size_t lowest = 0;
+    // Number of entries, including the ones of the properties destroyed since
+    std::size_t count = 0;
+    bool running = false;
+    int batches = 0;
+    propagation_scheduler *scheduler = nullptr;
+    std::vector<property_base *> level, notified;
+#ifdef PROPERTY_RECORDING
+    // Set while evaluating a property for a propagation running in another thread
+    bool detached = false;
+    bool propagating() const { return running || detached; }
+#endif
+    // Number of evaluations of the cyclic properties during this run
+    std::vector<std::pair<property_base *, unsigned>> cyclicEvaluations;
+
+    static bool testAndSet(bool &flag) { bool old = flag; flag = true; return old; }
+#ifdef PROPERTY_THREAD_SAFE
+    static bool testAndSet(std::atomic<bool> &flag) { return flag.exchange(true); }
+#endif
+
+    void schedule(property_base *p) {
+      if (testAndSet(p->scheduled))
+        return;
+      push(p);
+    }
+    void push(property_base *p) {
+      unsigned h = p->height;
+      if (h >= buckets.size())
+        buckets.resize(h + 1);
+      buckets[h].push_back(p);
+      lowest = std::min<std::size_t>(lowest, h);
+      ++count;
+    }
+    void remove(property_base *p) {
+      for (std::size_t h = lowest; h < buckets.size(); ++h) {
+        for (property_base *&q : buckets[h]) {
+          if (q == p)
+            q = nullptr;
+        }
+      }
+    }
+    // Moves all the entries to 'out'
+    void takeAll(std::vector<property_base *> &out) {
+      for (std::size_t h = lowest; count; ++h) {
+        for (property_base *p : buckets[h]) {
+          if (p)
+            out.push_back(p);
+        }
+        count -= buckets[h].size();
+        buckets[h].clear();
+      }
+    }
+    /* If a binding throws, the exception propagates to the write that started the run, and
+       the properties still scheduled are dropped: they keep their value until one of their
+       dependencies changes again. */
+    void run() {
+      if (running || batches)
+        return;
+      running = true;
+      struct run_guard {
+        propagation_queue &q;
+        ~run_guard() {
+          if (q.count || !q.notified.empty())
+            q.drop();
+          q.cyclicEvaluations.clear();
+          q.running = false;
+        }
+      } guard{*this};
+      while (count) {
+        while (buckets[lowest].empty())
+          ++lowest;
+        if (scheduler && buckets[lowest].size() > 1) {
+          evaluateLevel();
+          continue;
+        }
+        property_base *p = buckets[lowest].back();
+        buckets[lowest].pop_back();
+        --count;
+        if (!p)
+          continue;
+        if (p->height != lowest) {
+          push(p);
+          continue;
+        }
+        p->scheduled = false;
+        if (p->cyclic && !mayEvaluateCyclic(p))
+          continue;
+        p->evaluate();
+      }
+    }
+    void drop() {
+      for (std::size_t h = lowest; h < buckets.size(); ++h) {
+        for (property_base *p : buckets[h]) {
+          if (p)
+            p->scheduled = false;
+        }
+        buckets[h].clear();
+      }
+      // Taken from the scheduler of a level that did not complete
+      for (property_base *p : notified)
+        p->scheduled = false;
+      notified.clear();
+      count = 0;
+      lowest = 0;
+    }
+
+    bool mayEvaluateCyclic(property_base *p) {
+      for (auto &c : cyclicEvaluations) {
+        if (c.first != p)
+          continue;
+        if (c.second >= cycleSettings().maxIterations) {
+          ++cycleStatistics().truncated;
+          return false;
+        }
+        ++c.second;
+        return true;
+      }
+      cyclicEvaluations.emplace_back(p, 1);
+      return true;
+    }
+    void forgetCyclic(property_base *p) {
+      for (auto &c : cyclicEvaluations) {
+        if (c.first == p)
+          c.first = nullptr;
+      }
+    }
+
+    // Hands the whole lowest bucket to the scheduler
+    void evaluateLevel() {
+      std::size_t h = lowest;
+      level.clear();
+      level.swap(buckets[h]);
+      count -= level.size();
+      level.erase(std::remove(level.begin(), level.end(), nullptr), level.end());
+      for (std::size_t i = 0; i < level.size();) {
+        if (level[i]->height != h) {
+          push(level[i]);
+        } else {
+          level[i]->scheduled = false;
+          if (!level[i]->cyclic || mayEvaluateCyclic(level[i])) {
+            ++i;
+            continue;
+          }
+        }
+        level[i] = level.back();
+        level.pop_back();
+      }
+      notified.clear();
+      scheduler->evaluateLevel(level, notified);
+      for (property_base *p : notified)
+        push(p);
+      notified.clear();
+    }
+  };
+  static propagation_queue &queue() { static thread_local propagation_queue q; return q; }
+
+  // Never destroyed, since properties with static storage may still use it at exit
+  static property_allocator *&allocator() { static property_allocator *a = new property_pool; return a; }
 };
 
-//FIXME move to .cpp file
-property_base *property_base::current = 0;
+/** Specialize this trait to std::true_type to compare the values of every property<T> with
+    operator== by default, so that they do not notify when their value does not change. */
+template <typename T> struct property_cutoff : std::false_type {};
 
 /** The property class represents a property of type T that can be assigned a value, or a bindings.
     When assigned a bindings, the binding is re-evaluated whenever one of the property used in it
     is changed */
 template <typename T>
 struct property : property_base {
-  typedef std::function<T()> binding_t;
+  typedef property_function<T()> binding_t;
+  typedef bool (*compare_t)(const T &, const T &);
 
   property() = default;
   property(const T &t) : value(t) {}
+  property(T &&t) : value(std::move(t)) {}
   property(const binding_t &b) : binding(b) { evaluate(); }
+  property(const property &) = default;
+  property(property &&) = default;
 
-  void operator=(const T &t) {
-      value = t;
-      clearDependencies();
-      notify();
+  // Copies the value, or the binding with its dependencies, and notifies the subscribers
+  property &operator=(const property &other) {
+    if (this == &other)
+      return *this;
+    property_base::operator=(other);
+    value = other.value;
+    binding = other.binding;
+    compare = other.compare;
+    lazy = other.lazy;
+    stale = other.stale;
+    notify();
+    return *this;
   }
+
+  void operator=(const T &t) { assign(t); }
+  void operator=(T &&t) { assign(std::move(t)); }
   void operator=(const binding_t &b) {
       binding = b;
       evaluate();
   }
 
+  /* Calls f with a reference to the value, to change it in place, then notifies once.
+     Like an assignment, it removes the dependencies. The comparator is not used, since
+     the previous value is not kept. */
+  template <typename F> void modify(F f) {
+      if (stale)
+        update();
+      clearDependencies();
+      f(value);
+      stale = false;
+      notify();
+  }
+
+  /* In lazy mode, a change of a dependency only marks the binding as outdated and the
+     binding is evaluated the next time the property is read. Writes to the dependencies
+     that are not followed by a read then cost almost nothing. */
+  void setLazy(bool l) {
+    lazy = l;
+    if (!lazy && stale)
+      update();
+  }
+  bool isLazy() const { return lazy; }
+
+  /* When a comparator is set, assigning or evaluating to a value equal to the current one
+     does not notify the subscribers. A lazy property still notifies when it becomes stale,
+     since its new value is not known yet. */
+  void setComparator(compare_t c) { compare = c; }
+  void setEqualityCutoff(bool enabled) { compare = enabled ? equalityComparator(std::true_type()) : nullptr; }
+
   //make it possible to initialize directly with lamda without any casts
   template<typename B> property(const B &b, typename std::enable_if<std::is_constructible<T, B>::value, int*>::type = nullptr) : property(T(b)) {}
   template<typename B> typename std::enable_if<std::is_constructible<T, B>::value>::type operator= (const B &b) { *this=T(b); }
@@ -119,6 +1076,8 @@ struct property : property_base {
 
   const T &get() const {
     const_cast<property*>(this)->accessed();
+    if (stale)
+      const_cast<property*>(this)->update();
     return value;
   }
 
@@ -127,22 +1086,97 @@ struct property : property_base {
   operator const T&() const { return get(); }
 
   void evaluate() override {
-    if (binding) {
-      clearDependencies();
-      evaluation_scope scope(this);
-      value = binding();
+    if (binding)
+      evaluateWith(binding);
+    else
+      notify();
+  }
+
+protected:
+  // Value-initialized, so the comparator of a property without a value yet reads a defined one
+  T value = T();
+  binding_t binding;
+
+  // Evaluates the binding f, or only marks the property as stale in lazy mode
+  template <typename F> void evaluateWith(F &f) {
+    if (lazy) {
+      // The subscribers were already notified when it became stale
+      if (stale)
+        return;
+      stale = true;
+    } else if (!updateWith(f)) {
+      cutoff();
+      return;
     }
     notify();
   }
 
+  // Returns false if the value did not change
+  template <typename F> bool updateWith(F &f) {
+    evaluation_scope scope(this);
+    stale = false;
+    T v = f();
+    if (compare && compare(value, v))
+      return false;
+    value = std::move(v);
+    return true;
+  }
+
+  // Called by get() when a lazy property is stale
+  virtual bool update() { return updateWith(binding); }
+
+private:
+  template <typename U> void assign(U &&t) {
+      clearDependencies();
+      if (compare && !stale && compare(value, t)) {
+        cutoff();
+        return;
+      }
+      value = std::forward<U>(t);
+      stale = false;
+      notify();
+  }
+
+  static compare_t equalityComparator(std::true_type) {
+    return [](const T &a, const T &b) { return a == b; };
+  }
+  static compare_t equalityComparator(std::false_type) { return nullptr; }
+
+  compare_t compare = equalityComparator(property_cutoff<T>());
+  bool lazy = false;
+  bool stale = false;
+};
+
+/** A property whose binding is stored with its own type rather than as a binding_t.
+    The call to the binding can be inlined, and creating it never allocates.
+    Use make_property() to create one from a lambda. */
+template <typename T, typename F>
+struct bound_property : property<T> {
+  explicit bound_property(F f) : function(std::move(f)) { this->evaluateWith(function); }
+  using property<T>::operator=;
+
+  void evaluate() override {
+    if (this->binding)
+      property<T>::evaluate();
+    else
+      this->evaluateWith(function);
+  }
+
 protected:
-  T value;
-  binding_t binding;
+  bool update() override { return this->binding ? property<T>::update() : this->updateWith(function); }
+
+private:
+  F function;
 };
 
+template <typename F>
+bound_property<typename std::decay<decltype(std::declval<F &>()())>::type, F> make_property(F f) {
+  return bound_property<typename std::decay<decltype(std::declval<F &>()())>::type, F>(std::move(f));
+}
+
 template<typename T>
 struct property_hook : property<T> {
-  typedef std::function<void()> hook_t;
+  typedef property_function<void()> hook_t;
   typedef typename property<T>::binding_t binding_t;
   void notify() override {
     property<T>::notify();
@@ -150,23 +1184,35 @@ struct property_hook : property<T> {
   }
   property_hook(hook_t h) : hook(h) { }
   property_hook(hook_t h, const T &t) : property<T>(t), hook(h) { }
+  property_hook(hook_t h, T &&t) : property<T>(std::move(t)), hook(h) { }
   property_hook(hook_t h, binding_t b) : property<T>(b), hook(h) { }
   using property<T>::operator=;
 private:
   hook_t hook;
 };
 
-/** property_wrapper do not own the property, but use a getter and a setter */
+/** property_wrapper do not own the property, but use a getter and a setter.
+    In cached mode, get() keeps the value returned by the getter and only calls it again after
+    the next notify(). This is only correct if notify() is called whenever the underlying value
+    changes, which is what the QtWrapper classes do from their event handlers. */
 template <typename T>
 struct property_wrapper : property_base {
-  typedef std::function<T()> binding_t;
-  typedef std::function<void(const T&)> write_hook_t;
-  typedef std::function<T()> read_hook_t;
+  typedef property_function<T()> binding_t;
+  typedef property_function<void(const T&)> write_hook_t;
+  typedef property_function<T()> read_hook_t;
   explicit property_wrapper(write_hook_t w, read_hook_t r) : write_hook(std::move(w)), read_hook(std::move(r)) { }
 
   T get() const {
     const_cast<property_wrapper*>(this)->accessed();
-    return read_hook();
+    if (!cached)
+      return read_hook();
+    return read();
+  }
+  /* Reads into the cache and returns it, without copying it again. In cached mode, the
+     reference stays valid until the next notify(), otherwise until the next read. */
+  const T &getReference() const {
+    const_cast<property_wrapper*>(this)->accessed();
+    return read();
   }
   void operator=(const T &t) {
     write_hook(t);
@@ -181,18 +1227,38 @@ struct property_wrapper : property_base {
   T operator()() const { return get(); }
   operator T() const { return get(); }
 
-  using property_base::notify;
+  void setCached(bool c) {
+    cached = c;
+    cacheValid = false;
+  }
+  bool isCached() const { return cached; }
+
+  /* Must be called when the wrapped value changes behind the wrapper's back. */
+  void notify() override {
+    cacheValid = false;
+    property_base::notify();
+  }
 protected:
   void evaluate() override {
     if (binding) {
-      clearDependencies();
       evaluation_scope scope(this);
       write_hook(binding());
     }
     notify();
   }
 private:
+  const T &read() const {
+    if (!cached || !cacheValid) {
+      cache = read_hook();
+      cacheValid = cached;
+    }
+    return cache;
+  }
+
   const write_hook_t write_hook;
   const read_hook_t read_hook;
   binding_t binding;
+  bool cached = false;
+  mutable bool cacheValid = false;
+  mutable T cache = T();
 };
@@ -0,0 +1,113 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+#include "property.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/** A column of values of type T stored contiguously, and tracked as a single property.
+    A binding is shared by all the elements: bind() computes every element from the elements
+    with the same index in other columns, in a loop where the function is inlined, so simple
+    bindings are vectorized by the compiler.
+    Changing any element notifies the subscribers of the whole column; use update() to change
+    many elements at once. */
+template <typename T>
+class property_array : public property_base {
+public:
+  typedef property_function<void(T *, std::size_t)> binding_t;
+
+  property_array() = default;
+  explicit property_array(std::size_t n, const T &t = T()) : values(n, t) {}
+
+  std::size_t size() const {
+    const_cast<property_array *>(this)->accessed();
+    return values.size();
+  }
+  void resize(std::size_t n, const T &t = T()) {
+    values.resize(n, t);
+    evaluate();
+  }
+
+  const T &get(std::size_t i) const {
+    const_cast<property_array *>(this)->accessed();
+    return values[i];
+  }
+  const T &operator[](std::size_t i) const { return get(i); }
+  const T *data() const {
+    const_cast<property_array *>(this)->accessed();
+    return values.data();
+  }
+
+  void set(std::size_t i, const T &t) {
+    values[i] = t;
+    clearBinding();
+    notify();
+  }
+  void set(std::size_t i, T &&t) {
+    values[i] = std::move(t);
+    clearBinding();
+    notify();
+  }
+  void fill(const T &t) {
+    std::fill(values.begin(), values.end(), t);
+    clearBinding();
+    notify();
+  }
+  // Calls f(data, size) to modify the elements in place, and notifies once
+  template <typename F> void update(F f) {
+    f(values.data(), values.size());
+    clearBinding();
+    notify();
+  }
+
+  /* Binds every element i to f(sources[i]...). The sources must have at least as many
+     elements as this column. */
+  template <typename F, typename... U> void bind(F f, const property_array<U> &... sources) {
+    binding = [f, &sources...](T *out, std::size_t n) {
+      apply(out, n, f, sources.data()...);
+    };
+    evaluate();
+  }
+
+  void evaluate() override {
+    if (binding) {
+      evaluation_scope scope(this);
+      binding(values.data(), values.size());
+    }
+    notify();
+  }
+
+private:
+  template <typename F, typename... U>
+  static void apply(T *out, std::size_t n, const F &f, const U *... in) {
+    for (std::size_t i = 0; i < n; ++i)
+      out[i] = f(in[i]...);
+  }
+
+  void clearBinding() {
+    binding = nullptr;
+    clearDependencies();
+  }
+
+  std::vector<T> values;
+  binding_t binding;
+};
@@ -0,0 +1,218 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "property.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** Runs the work of the asynchronous bindings, on other threads. */
+struct property_executor {
+  virtual ~property_executor() {}
+  virtual void execute(property_function<void()> job) = 0;
+};
+
+/** A fixed number of threads running the jobs in the order they were submitted.
+    The jobs which did not start when the pool is destroyed are dropped. */
+class property_thread_pool : public property_executor {
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<property_function<void()>> jobs;
+  std::vector<std::thread> threads;
+  bool stopping = false;
+
+  void work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      wake.wait(lock, [this]{ return stopping || !jobs.empty(); });
+      if (stopping)
+        return;
+      property_function<void()> job = std::move(jobs.front());
+      jobs.pop_front();
+      lock.unlock();
+      job();
+      lock.lock();
+    }
+  }
+
+public:
+  explicit property_thread_pool(unsigned count = std::max(1u, std::thread::hardware_concurrency())) {
+    for (unsigned i = 0; i < count; ++i)
+      threads.emplace_back([this]{ work(); });
+  }
+  property_thread_pool(const property_thread_pool &) = delete;
+  property_thread_pool &operator=(const property_thread_pool &) = delete;
+  ~property_thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &t : threads)
+      t.join();
+  }
+
+  void execute(property_function<void()> job) override {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+  }
+};
+
+/** Brings the results of the asynchronous bindings back to the thread owning the properties,
+    which publishes them by calling drain(), for instance once per event loop iteration.
+    'wakeup' is called from the thread posting a result when the queue was empty, so that the
+    owner thread can schedule a drain() (with Qt: a queued QMetaObject::invokeMethod). */
+class property_dispatcher {
+  std::mutex mutex;
+  std::vector<property_function<void()>> queue;
+  property_function<void()> wakeup;
+
+public:
+  explicit property_dispatcher(property_function<void()> w = nullptr) : wakeup(std::move(w)) {}
+  property_dispatcher(const property_dispatcher &) = delete;
+  property_dispatcher &operator=(const property_dispatcher &) = delete;
+
+  void post(property_function<void()> f) {
+    bool first;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      first = queue.empty();
+      queue.push_back(std::move(f));
+    }
+    if (first && wakeup)
+      wakeup();
+  }
+
+  /* Publishes the results received so far, in one batch, and returns how many there were. */
+  std::size_t drain() {
+    std::vector<property_function<void()>> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ready.swap(queue);
+    }
+    property_base::batch b;
+    for (auto &f : ready)
+      f();
+    return ready.size();
+  }
+};
+
+/** A property whose binding is split in two: the binding itself runs on the owner thread,
+    reads the properties it depends on, and returns a task computing the value from what it
+    read. The task runs on the executor and must not access any property. Until its result is
+    published by the dispatcher, the property keeps its previous value.
+    Every evaluation supersedes the previous ones: a superseded task is skipped if it did not
+    start yet, and its result is discarded otherwise.
+    The executor must stop running tasks before the dispatcher is destroyed. */
+template <typename T>
+class async_property : public property_base {
+public:
+  typedef property_function<T()> task_t;
+  typedef property_function<task_t()> binding_t;
+
+  async_property(property_executor &e, property_dispatcher &d, const T &t = T())
+    : value(t), state(std::make_shared<shared_state>(this)), executor(e), dispatcher(d) {}
+  async_property(property_executor &e, property_dispatcher &d, const binding_t &b)
+    : async_property(e, d) { *this = b; }
+  async_property(const async_property &) = delete;
+  async_property &operator=(const async_property &) = delete;
+  ~async_property() { state->owner = nullptr; }
+
+  void operator=(const T &t) {
+    clearDependencies();
+    binding = binding_t();
+    ++state->generation;
+    pending = false;
+    value = t;
+    notify();
+  }
+  void operator=(const binding_t &b) {
+    binding = b;
+    evaluate();
+  }
+
+  T get() const {
+    const_cast<async_property*>(this)->accessed();
+    return value;
+  }
+  T operator()() const { return get(); }
+  operator T() const { return get(); }
+
+  // Whether a task was started and its result was not published yet
+  bool isPending() const { return pending; }
+
+protected:
+  void evaluate() override {
+    if (!binding)
+      return;
+    task_t task;
+    {
+      evaluation_scope scope(this);
+      task = binding();
+    }
+    unsigned generation = ++state->generation;
+    pending = true;
+    std::shared_ptr<shared_state> s = state;
+    property_dispatcher *d = &dispatcher;
+    executor.execute([s, generation, task, d]() {
+      if (s->generation != generation)
+        return;
+      T result = task();
+      if (s->generation != generation)
+        return;
+      d->post([s, generation, result]() {
+        if (s->owner && s->generation == generation)
+          s->owner->publish(result);
+      });
+    });
+  }
+
+private:
+  // Shared with the tasks, which may outlive the property
+  struct shared_state {
+    explicit shared_state(async_property *p) : owner(p) {}
+    std::atomic<unsigned> generation{0};
+    // Only accessed from the owner thread
+    async_property *owner;
+  };
+
+  void publish(const T &t) {
+    pending = false;
+    value = t;
+    notify();
+  }
+
+  T value;
+  bool pending = false;
+  binding_t binding;
+  std::shared_ptr<shared_state> state;
+  property_executor &executor;
+  property_dispatcher &dispatcher;
+};
@@ -0,0 +1,532 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "property.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+/** Collections recording what changed in them, so that the properties computed from them can
+    apply the changes instead of reading the whole collection again: property_list and
+    property_map, and the incremental operators list_map, list_filter, collection_sum and
+    collection_count.
+    The changes are kept in a log numbered by revision. A consumer remembers the revision it
+    has seen and replays the changes since then. The oldest changes are dropped once the log
+    is longer than the collection, and assigning the whole collection drops them all: a
+    consumer which missed changes reads the whole collection instead. */
+
+/* One change of a collection. 'key' is the index in a list, or the key in a map. */
+template <typename Key, typename T>
+struct collection_change {
+  enum kind_t { insert, remove, update };
+  kind_t kind;
+  Key key;
+  T oldValue; // for remove and update
+  T newValue; // for insert and update
+};
+
+template <typename Key, typename T>
+class collection_log {
+public:
+  typedef collection_change<Key, T> change;
+
+  unsigned long revision() const { return first + entries.size(); }
+
+  // 'size' is the size of the collection, which bounds the length of the log
+  void record(change c, std::size_t size) {
+    if (entries.size() > std::max<std::size_t>(64, size)) {
+      std::size_t dropped = entries.size() / 2;
+      entries.erase(entries.begin(), entries.begin() + dropped);
+      first += dropped;
+    }
+    entries.push_back(std::move(c));
+  }
+
+  // Forgets all the changes, when the whole collection was replaced
+  void reset() {
+    first = revision() + 1;
+    entries.clear();
+  }
+
+  /* Calls f on every change since 'since', and sets it to the current revision.
+     Returns false without calling f when some of these changes were dropped. */
+  template <typename F> bool replay(unsigned long &since, F &f) const {
+    if (since < first) {
+      since = revision();
+      return false;
+    }
+    for (std::size_t i = since - first; i < entries.size(); ++i)
+      f(entries[i]);
+    since = revision();
+    return true;
+  }
+
+private:
+  std::vector<change> entries;
+  // Revision of entries[0]
+  unsigned long first = 0;
+};
+
+namespace property_collection_detail {
+
+/* A sequence of bits which can count the bits set before an index. The count goes from the
+   nearest end, a word at a time, so it is constant near the ends, such as for an append. */
+class rank_bits {
+  std::vector<std::uint64_t> words;
+  std::size_t count = 0;
+  std::size_t ones = 0;
+
+  static std::uint64_t below(std::size_t bit) { return (std::uint64_t(1) << bit) - 1; }
+  static std::size_t popcount(std::uint64_t w) { return std::bitset<64>(w).count(); }
+
+public:
+  std::size_t size() const { return count; }
+  bool operator[](std::size_t i) const { return (words[i / 64] >> (i % 64)) & 1; }
+
+  void set(std::size_t i, bool b) {
+    if ((*this)[i] == b)
+      return;
+    words[i / 64] ^= std::uint64_t(1) << (i % 64);
+    ones += b ? 1 : std::size_t(-1);
+  }
+
+  void insert(std::size_t i, bool b) {
+    if (count % 64 == 0)
+      words.push_back(0);
+    std::size_t w = i / 64;
+    for (std::size_t k = words.size() - 1; k > w; --k)
+      words[k] = (words[k] << 1) | (words[k - 1] >> 63);
+    std::uint64_t low = words[w] & below(i % 64);
+    words[w] = low | ((words[w] & ~low) << 1) | (std::uint64_t(b) << (i % 64));
+    ++count;
+    ones += b;
+  }
+
+  void erase(std::size_t i) {
+    ones -= (*this)[i];
+    std::size_t w = i / 64;
+    std::uint64_t low = words[w] & below(i % 64);
+    words[w] = low | ((words[w] >> 1) & ~below(i % 64));
+    for (std::size_t k = w; k + 1 < words.size(); ++k) {
+      words[k] |= (words[k + 1] & 1) << 63;
+      words[k + 1] >>= 1;
+    }
+    if (--count % 64 == 0)
+      words.pop_back();
+  }
+
+  void clear() {
+    words.clear();
+    count = ones = 0;
+  }
+
+  // Number of bits set before i
+  std::size_t rank(std::size_t i) const {
+    std::size_t w = i / 64, n = 0;
+    if (i <= count / 2) {
+      for (std::size_t k = 0; k < w; ++k)
+        n += popcount(words[k]);
+      return w < words.size() ? n + popcount(words[w] & below(i % 64)) : n;
+    }
+    for (std::size_t k = w + 1; k < words.size(); ++k)
+      n += popcount(words[k]);
+    if (w < words.size())
+      n += popcount(words[w] & ~below(i % 64));
+    return ones - n;
+  }
+};
+
+}
+
+/** The read side of a list, shared by property_list and the operators producing lists. */
+template <typename T>
+class property_list_base : public property_base {
+public:
+  typedef T value_type;
+  typedef std::size_t key_type;
+  typedef collection_change<std::size_t, T> change;
+
+  std::size_t size() const {
+    const_cast<property_list_base *>(this)->accessed();
+    return values.size();
+  }
+  const T &operator[](std::size_t i) const {
+    const_cast<property_list_base *>(this)->accessed();
+    return values[i];
+  }
+  const std::vector<T> &get() const {
+    const_cast<property_list_base *>(this)->accessed();
+    return values;
+  }
+  template <typename F> void forEachValue(F f) const {
+    for (const T &v : get())
+      f(v);
+  }
+
+  unsigned long revision() const { return log.revision(); }
+  // See collection_log::replay()
+  template <typename F> bool changesSince(unsigned long &since, F f) const {
+    const_cast<property_list_base *>(this)->accessed();
+    return log.replay(since, f);
+  }
+
+protected:
+  property_list_base() = default;
+  explicit property_list_base(std::vector<T> v) : values(std::move(v)) {}
+
+  // Change the values and record it, without notifying
+  void insertAt(std::size_t i, T v) {
+    log.record(change{change::insert, i, T(), v}, values.size());
+    values.insert(values.begin() + i, std::move(v));
+  }
+  void eraseAt(std::size_t i) {
+    log.record(change{change::remove, i, values[i], T()}, values.size());
+    values.erase(values.begin() + i);
+  }
+  void setAt(std::size_t i, T v) {
+    log.record(change{change::update, i, values[i], v}, values.size());
+    values[i] = std::move(v);
+  }
+  void assignAll(std::vector<T> v) {
+    values = std::move(v);
+    log.reset();
+  }
+
+  std::vector<T> values;
+  collection_log<std::size_t, T> log;
+};
+
+/** A list of values. Every modification notifies once. */
+template <typename T>
+class property_list : public property_list_base<T> {
+public:
+  property_list() = default;
+  explicit property_list(std::vector<T> v) : property_list_base<T>(std::move(v)) {}
+
+  void push_back(T v) { insert(this->values.size(), std::move(v)); }
+  void insert(std::size_t i, T v) {
+    this->insertAt(i, std::move(v));
+    this->notify();
+  }
+  void erase(std::size_t i) {
+    this->eraseAt(i);
+    this->notify();
+  }
+  void set(std::size_t i, T v) {
+    this->setAt(i, std::move(v));
+    this->notify();
+  }
+  void assign(std::vector<T> v) {
+    this->assignAll(std::move(v));
+    this->notify();
+  }
+  void clear() { assign(std::vector<T>()); }
+
+  void evaluate() override { this->notify(); }
+};
+
+/** A map from keys to values. Every modification notifies once. */
+template <typename K, typename V>
+class property_map : public property_base {
+public:
+  typedef V value_type;
+  typedef K key_type;
+  typedef collection_change<K, V> change;
+
+  std::size_t size() const {
+    const_cast<property_map *>(this)->accessed();
+    return values.size();
+  }
+  bool contains(const K &k) const {
+    const_cast<property_map *>(this)->accessed();
+    return values.count(k) != 0;
+  }
+  const V &at(const K &k) const {
+    const_cast<property_map *>(this)->accessed();
+    return values.at(k);
+  }
+  const std::map<K, V> &get() const {
+    const_cast<property_map *>(this)->accessed();
+    return values;
+  }
+  template <typename F> void forEachValue(F f) const {
+    for (const auto &kv : get())
+      f(kv.second);
+  }
+
+  // Inserts the key, or changes its value
+  void set(const K &k, V v) {
+    typename std::map<K, V>::iterator it = values.find(k);
+    if (it == values.end()) {
+      log.record(change{change::insert, k, V(), v}, values.size());
+      values.emplace(k, std::move(v));
+    } else {
+      log.record(change{change::update, k, it->second, v}, values.size());
+      it->second = std::move(v);
+    }
+    notify();
+  }
+  // Returns false if the key was not there
+  bool erase(const K &k) {
+    typename std::map<K, V>::iterator it = values.find(k);
+    if (it == values.end())
+      return false;
+    log.record(change{change::remove, k, it->second, V()}, values.size());
+    values.erase(it);
+    notify();
+    return true;
+  }
+  void clear() {
+    values.clear();
+    log.reset();
+    notify();
+  }
+
+  unsigned long revision() const { return log.revision(); }
+  // See collection_log::replay()
+  template <typename F> bool changesSince(unsigned long &since, F f) const {
+    const_cast<property_map *>(this)->accessed();
+    return log.replay(since, f);
+  }
+
+  void evaluate() override { notify(); }
+
+private:
+  std::map<K, V> values;
+  collection_log<K, V> log;
+};
+
+/** The list of f(v) for every v of a source list. f is called once per inserted or updated
+    element of the source. */
+template <typename T, typename F,
+          typename U = typename std::decay<decltype(std::declval<F &>()(std::declval<const T &>()))>::type>
+class list_map : public property_list_base<U> {
+  typedef typename property_list_base<T>::change source_change;
+public:
+  list_map(const property_list_base<T> &s, F f) : source(s), function(std::move(f)) {
+    property_base::evaluation_scope scope(this);
+    reload();
+  }
+
+  void evaluate() override {
+    unsigned long before = this->revision();
+    {
+      property_base::evaluation_scope scope(this);
+      auto apply = [this](const source_change &c) {
+        switch (c.kind) {
+          case source_change::insert: this->insertAt(c.key, function(c.newValue)); break;
+          case source_change::remove: this->eraseAt(c.key); break;
+          case source_change::update: this->setAt(c.key, function(c.newValue)); break;
+        }
+      };
+      if (!source.changesSince(seen, apply))
+        reload();
+    }
+    if (this->revision() != before)
+      this->notify();
+  }
+
+private:
+  void reload() {
+    std::vector<U> v;
+    v.reserve(source.size());
+    source.forEachValue([&](const T &t) { v.push_back(function(t)); });
+    this->assignAll(std::move(v));
+    seen = source.revision();
+  }
+
+  const property_list_base<T> &source;
+  F function;
+  unsigned long seen = 0;
+};
+
+/** The elements of a source list for which pred(v) is true, in the same order. pred is called
+    once per inserted or updated element of the source. */
+template <typename T, typename P>
+class list_filter : public property_list_base<T> {
+  typedef typename property_list_base<T>::change source_change;
+public:
+  list_filter(const property_list_base<T> &s, P p) : source(s), pred(std::move(p)) {
+    property_base::evaluation_scope scope(this);
+    reload();
+  }
+
+  void evaluate() override {
+    unsigned long before = this->revision();
+    {
+      property_base::evaluation_scope scope(this);
+      auto apply = [this](const source_change &c) {
+        std::size_t i = c.key;
+        std::size_t position = kept.rank(i);
+        switch (c.kind) {
+          case source_change::insert:
+            kept.insert(i, pred(c.newValue));
+            if (kept[i])
+              this->insertAt(position, c.newValue);
+            break;
+          case source_change::remove:
+            if (kept[i])
+              this->eraseAt(position);
+            kept.erase(i);
+            break;
+          case source_change::update: {
+            bool keep = pred(c.newValue);
+            if (kept[i] && keep)
+              this->setAt(position, c.newValue);
+            else if (kept[i])
+              this->eraseAt(position);
+            else if (keep)
+              this->insertAt(position, c.newValue);
+            kept.set(i, keep);
+            break;
+          }
+        }
+      };
+      if (!source.changesSince(seen, apply))
+        reload();
+    }
+    if (this->revision() != before)
+      this->notify();
+  }
+
+private:
+  void reload() {
+    std::vector<T> v;
+    kept.clear();
+    source.forEachValue([&](const T &t) {
+      bool keep = pred(t);
+      kept.insert(kept.size(), keep);
+      if (keep)
+        v.push_back(t);
+    });
+    this->assignAll(std::move(v));
+    seen = source.revision();
+  }
+
+  const property_list_base<T> &source;
+  P pred;
+  // For every element of the source, whether it is in the list. Counting the kept elements
+  // before an index gives its position in the list.
+  property_collection_detail::rank_bits kept;
+  unsigned long seen = 0;
+};
+
+/** The sum of the values of a collection (a list or a map), updated by adding the inserted
+    values and subtracting the removed ones. */
+template <typename C, typename R = typename C::value_type>
+class collection_sum : public property<R> {
+  typedef typename C::change change;
+public:
+  explicit collection_sum(const C &c) : source(c) { evaluate(); }
+
+  void evaluate() override {
+    auto f = [this]{ return compute(); };
+    this->evaluateWith(f);
+  }
+
+protected:
+  bool update() override {
+    auto f = [this]{ return compute(); };
+    return this->updateWith(f);
+  }
+
+private:
+  R compute() {
+    auto apply = [this](const change &c) {
+      if (c.kind != change::insert)
+        total -= c.oldValue;
+      if (c.kind != change::remove)
+        total += c.newValue;
+    };
+    if (!source.changesSince(seen, apply)) {
+      total = R();
+      source.forEachValue([this](const typename C::value_type &v) { total += v; });
+    }
+    return total;
+  }
+
+  const C &source;
+  R total = R();
+  unsigned long seen = 0;
+};
+
+/** The number of values of a collection for which pred(v) is true. */
+template <typename C, typename P>
+class collection_count : public property<std::size_t> {
+  typedef typename C::change change;
+public:
+  collection_count(const C &c, P p) : source(c), pred(std::move(p)) { evaluate(); }
+
+  void evaluate() override {
+    auto f = [this]{ return compute(); };
+    evaluateWith(f);
+  }
+
+protected:
+  bool update() override {
+    auto f = [this]{ return compute(); };
+    return updateWith(f);
+  }
+
+private:
+  std::size_t compute() {
+    auto apply = [this](const change &c) {
+      if (c.kind != change::insert && pred(c.oldValue))
+        --count;
+      if (c.kind != change::remove && pred(c.newValue))
+        ++count;
+    };
+    if (!source.changesSince(seen, apply)) {
+      count = 0;
+      source.forEachValue([this](const typename C::value_type &v) { count += pred(v) ? 1 : 0; });
+    }
+    return count;
+  }
+
+  const C &source;
+  P pred;
+  std::size_t count = 0;
+  unsigned long seen = 0;
+};
+
+template <typename T, typename F>
+list_map<T, F> make_list_map(const property_list_base<T> &source, F f) {
+  return list_map<T, F>(source, std::move(f));
+}
+
+template <typename T, typename P>
+list_filter<T, P> make_list_filter(const property_list_base<T> &source, P pred) {
+  return list_filter<T, P>(source, std::move(pred));
+}
+
+template <typename C>
+collection_sum<C> make_sum(const C &source) {
+  return collection_sum<C>(source);
+}
+
+template <typename C, typename P>
+collection_count<C, P> make_count(const C &source, P pred) {
+  return collection_count<C, P>(source, std::move(pred));
+}
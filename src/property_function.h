@@ -0,0 +1,135 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/* Size of the buffer in which property_function stores the callable without allocating.
+   Lambdas capturing up to that many bytes (three pointers by default) are stored inline. */
+#ifndef PROPERTY_FUNCTION_INLINE_SIZE
+#define PROPERTY_FUNCTION_INLINE_SIZE (3 * sizeof(void *))
+#endif
+
+template <typename Signature, std::size_t InlineSize = PROPERTY_FUNCTION_INLINE_SIZE>
+class property_function;
+
+/** A replacement for std::function used to store the bindings and the hooks.
+    Callables that fit in InlineSize bytes and can be moved without throwing are stored in
+    the object itself, the bigger ones are allocated. */
+template <typename R, typename... Args, std::size_t InlineSize>
+class property_function<R(Args...), InlineSize> {
+  typedef typename std::aligned_storage<InlineSize, alignof(std::max_align_t)>::type storage_t;
+
+  enum operation { Copy, Move, Destroy };
+  typedef R (*invoke_t)(storage_t &, Args...);
+  typedef void (*manage_t)(operation, storage_t &dst, storage_t *src);
+
+  template <typename F> struct is_inline : std::integral_constant<bool,
+      sizeof(F) <= InlineSize && alignof(std::max_align_t) % alignof(F) == 0
+      && std::is_nothrow_move_constructible<F>::value> {};
+
+  template <typename F, bool = is_inline<F>::value> struct handler {
+    static F &get(storage_t &s) { return *reinterpret_cast<F *>(&s); }
+    static void create(storage_t &s, F &&f) { new (&s) F(std::move(f)); }
+    static void create(storage_t &s, const F &f) { new (&s) F(f); }
+    static void manage(operation op, storage_t &dst, storage_t *src) {
+      switch (op) {
+        case Copy: new (&dst) F(get(*src)); break;
+        case Move: new (&dst) F(std::move(get(*src))); get(*src).~F(); break;
+        case Destroy: get(dst).~F(); break;
+      }
+    }
+  };
+  template <typename F> struct handler<F, false> {
+    static F &get(storage_t &s) { return **reinterpret_cast<F **>(&s); }
+    static void create(storage_t &s, F &&f) { *reinterpret_cast<F **>(&s) = new F(std::move(f)); }
+    static void create(storage_t &s, const F &f) { *reinterpret_cast<F **>(&s) = new F(f); }
+    static void manage(operation op, storage_t &dst, storage_t *src) {
+      switch (op) {
+        case Copy: *reinterpret_cast<F **>(&dst) = new F(get(*src)); break;
+        case Move: *reinterpret_cast<F **>(&dst) = *reinterpret_cast<F **>(src); break;
+        case Destroy: delete *reinterpret_cast<F **>(&dst); break;
+      }
+    }
+  };
+
+  template <typename F> static R invoke(storage_t &s, Args... args) {
+    return handler<F>::get(s)(std::forward<Args>(args)...);
+  }
+
+  template <typename F> static auto callable(int) -> std::integral_constant<bool,
+      std::is_void<R>::value
+      || std::is_convertible<decltype(std::declval<F &>()(std::declval<Args>()...)), R>::value>;
+  template <typename F> static std::false_type callable(...);
+
+  storage_t storage;
+  invoke_t invoker = nullptr;
+  manage_t manager = nullptr;
+
+public:
+  property_function() = default;
+  property_function(std::nullptr_t) {}
+
+  template <typename F, typename D = typename std::decay<F>::type,
+            typename = typename std::enable_if<!std::is_same<D, property_function>::value
+                                               && decltype(callable<D>(0))::value>::type>
+  property_function(F &&f) {
+    if (!isEmpty(f)) {
+      handler<D>::create(storage, std::forward<F>(f));
+      invoker = &invoke<D>;
+      manager = &handler<D>::manage;
+    }
+  }
+
+  property_function(const property_function &other) : invoker(other.invoker), manager(other.manager) {
+    if (manager)
+      manager(Copy, storage, const_cast<storage_t *>(&other.storage));
+  }
+  property_function(property_function &&other) noexcept : invoker(other.invoker), manager(other.manager) {
+    if (manager)
+      manager(Move, storage, &other.storage);
+    other.invoker = nullptr;
+    other.manager = nullptr;
+  }
+  ~property_function() {
+    if (manager)
+      manager(Destroy, storage, nullptr);
+  }
+
+  property_function &operator=(property_function other) noexcept {
+    this->~property_function();
+    new (this) property_function(std::move(other));
+    return *this;
+  }
+
+  explicit operator bool() const { return invoker != nullptr; }
+
+  R operator()(Args... args) const {
+    return invoker(const_cast<storage_t &>(storage), std::forward<Args>(args)...);
+  }
+
+private:
+  template <typename F> static bool isEmpty(const F &) { return false; }
+  template <typename S> static bool isEmpty(const std::function<S> &f) { return !f; }
+  template <typename T> static bool isEmpty(T *f) { return !f; }
+};
@@ -0,0 +1,146 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PROPERTY_INSTRUMENTATION
+#error "property_instrumentation.h requires PROPERTY_INSTRUMENTATION to be defined before including property.h"
+#endif
+
+#include "property.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/** Reports of the statistics recorded for the live properties, to find the bindings that
+    are evaluated too often or take too long. Call them while no propagation is running. */
+namespace property_instrumentation {
+
+// The 'n' properties which spent the most time evaluating their binding, the slowest first
+inline std::vector<property_base *> hotList(std::size_t n) {
+  std::vector<property_base *> all;
+  property_base::forEachInstance([&](property_base *p) { all.push_back(p); });
+  n = std::min(n, all.size());
+  std::partial_sort(all.begin(), all.begin() + n, all.end(), [](property_base *a, property_base *b) {
+    return a->statistics().time > b->statistics().time;
+  });
+  all.resize(n);
+  return all;
+}
+
+namespace detail {
+
+inline std::string escape(const char *s) {
+  std::string r;
+  for (; s && *s; ++s) {
+    if (*s == '"' || *s == '\\') {
+      r += '\\';
+      r += *s;
+    } else if (static_cast<unsigned char>(*s) < 0x20) {
+      char buffer[8];
+      std::snprintf(buffer, sizeof(buffer), "\\u%04x", *s);
+      r += buffer;
+    } else {
+      r += *s;
+    }
+  }
+  return r;
+}
+
+// Numbers the live properties in the order of forEachInstance
+inline std::unordered_map<const property_base *, std::size_t> identifiers() {
+  std::unordered_map<const property_base *, std::size_t> ids;
+  property_base::forEachInstance([&](property_base *p) { ids.emplace(p, ids.size()); });
+  return ids;
+}
+
+}
+
+/* Writes the properties with their statistics, the edges from each dependency to the
+   property depending on it, and the identifiers of the 'hot' slowest properties:
+   { "properties": [ { "id", "name", "evaluations", "nanoseconds", "notifications", "fanIn",
+                       "fanOut", "depth" } ],
+     "edges": [ [ source, target ] ], "hot": [ id ] } */
+inline void writeJson(std::ostream &out, std::size_t hot = 10) {
+  std::unordered_map<const property_base *, std::size_t> ids = detail::identifiers();
+  out << "{\"properties\":[";
+  const char *separator = "";
+  property_base::forEachInstance([&](property_base *p) {
+    const property_statistics &s = p->statistics();
+    out << separator << "{\"id\":" << ids[p] << ",\"name\":";
+    if (s.name)
+      out << '"' << detail::escape(s.name) << '"';
+    else
+      out << "null";
+    out << ",\"evaluations\":" << s.evaluations << ",\"nanoseconds\":" << s.time.count()
+        << ",\"notifications\":" << s.notifications << ",\"fanIn\":" << p->fanIn()
+        << ",\"fanOut\":" << p->fanOut() << ",\"depth\":" << p->depth() << "}";
+    separator = ",";
+  });
+  out << "],\"edges\":[";
+  separator = "";
+  property_base::forEachInstance([&](property_base *p) {
+    p->forEachDependency([&](property_base *source) {
+      out << separator << "[" << ids[source] << "," << ids[p] << "]";
+      separator = ",";
+    });
+  });
+  out << "],\"hot\":[";
+  separator = "";
+  for (property_base *p : hotList(hot)) {
+    out << separator << ids[p];
+    separator = ",";
+  }
+  out << "]}\n";
+}
+
+/* Writes the graph in the Graphviz format, from the dependencies to the properties depending
+   on them. The properties are filled with a shade of red proportional to their share of the
+   time of the slowest one. */
+inline void writeDot(std::ostream &out) {
+  std::unordered_map<const property_base *, std::size_t> ids = detail::identifiers();
+  std::chrono::nanoseconds slowest(0);
+  property_base::forEachInstance([&](property_base *p) {
+    slowest = std::max(slowest, p->statistics().time);
+  });
+  out << "digraph properties {\n  node [shape=box, style=filled];\n";
+  property_base::forEachInstance([&](property_base *p) {
+    const property_statistics &s = p->statistics();
+    char heat[32];
+    std::snprintf(heat, sizeof(heat), "0.000 %.3f 1.000",
+                  slowest.count() ? double(s.time.count()) / slowest.count() : 0.);
+    out << "  p" << ids[p] << " [label=\"";
+    if (s.name)
+      out << detail::escape(s.name) << "\\n";
+    out << s.evaluations << " evaluations, " << s.time.count() / 1000 << " us\", fillcolor=\""
+        << heat << "\"];\n";
+  });
+  property_base::forEachInstance([&](property_base *p) {
+    p->forEachDependency([&](property_base *source) {
+      out << "  p" << ids[source] << " -> p" << ids[p] << ";\n";
+    });
+  });
+  out << "}\n";
+}
+
+}
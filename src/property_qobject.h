@@ -22,12 +22,101 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "property.h"
 
 #include <QtCore/QObject>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
 #include <QtCore/qmetaobject.h>
 
+#include <algorithm>
+#include <vector>
+
+/* Defers notifications to the event loop: the notifications scheduled during one event loop
+   iteration are delivered together from a single high priority posted event, inside a batch,
+   so that a property which changed many times (a window being resized, a slider being
+   dragged) is propagated once, before the widgets get painted.
+   Notifications scheduled while the queue is being flushed are delivered immediately, into
+   the same batch. There is one instance per thread. */
+class property_update_coalescer : public QObject {
+public:
+    /* Embedded in the object to notify, so scheduling it twice costs nothing. */
+    struct entry {
+        property_function<void()> notify;
+        bool queued = false;
+    };
+
+    static property_update_coalescer &instance() {
+        static thread_local property_update_coalescer *c = nullptr;
+        if (!c)
+            c = new property_update_coalescer;
+        return *c;
+    }
+
+    void schedule(entry *e) {
+        if (flushing) {
+            e->notify();
+            return;
+        }
+        if (e->queued)
+            return;
+        e->queued = true;
+        pending.push_back(e);
+        if (!posted) {
+            posted = true;
+            QCoreApplication::postEvent(this, new QEvent(eventType()), Qt::HighEventPriority);
+        }
+    }
+
+    /* Must be called before destroying a queued entry. */
+    void cancel(entry *e) {
+        if (!e->queued)
+            return;
+        e->queued = false;
+        std::replace(pending.begin(), pending.end(), e, static_cast<entry *>(nullptr));
+    }
+
+    /* Delivers the pending notifications now. */
+    void flush() {
+        posted = false;
+        bool wasFlushing = flushing;
+        flushing = true;
+        {
+            property_base::batch b;
+            // Cancelled entries are left as null, the vector does not grow while flushing
+            for (std::size_t i = 0; i < pending.size(); ++i) {
+                if (entry *e = pending[i]) {
+                    e->queued = false;
+                    e->notify();
+                }
+            }
+            pending.clear();
+        }
+        flushing = wasFlushing;
+    }
+
+protected:
+    bool event(QEvent *e) override {
+        if (e->type() != eventType())
+            return QObject::event(e);
+        flush();
+        return true;
+    }
+
+private:
+    static QEvent::Type eventType() {
+        static const QEvent::Type type = QEvent::Type(QEvent::registerEventType());
+        return type;
+    }
+
+    std::vector<entry *> pending;
+    bool posted = false;
+    bool flushing = false;
+};
+
 class property_qobject_base : public property_base,  private QObject {
 
     QObject *obj;
     QMetaProperty prop;
+    property_update_coalescer::entry pendingNotify;
+    bool coalesced = false;
 
 public:
     property_qobject_base(QObject *o, const char *p) : obj(o) {
@@ -36,7 +125,25 @@ public:
         int idx = prop.notifySignalIndex();
         if (idx >= 0)
             bindToSignal(idx);
+        pendingNotify.notify = [this]{ notify(); };
+        setName(prop.name());
+    }
+    ~property_qobject_base() {
+        if (pendingNotify.queued)
+            property_update_coalescer::instance().cancel(&pendingNotify);
+    }
+
+    /* In coalesced mode, the changes signaled by the object are propagated once per event
+       loop iteration by the property_update_coalescer instead of on every signal.
+       Leaving it propagates the pending change right away. */
+    void setCoalesced(bool c) {
+        coalesced = c;
+        if (!c && pendingNotify.queued) {
+            property_update_coalescer::instance().cancel(&pendingNotify);
+            notify();
+        }
     }
+    bool isCoalesced() const { return coalesced; }
 
     void bindToSignal(int signalIndex) {
         QMetaObject::connect(obj, signalIndex, this, staticMetaObject.methodCount());
@@ -46,7 +153,10 @@ private:
         idx = QObject::qt_metacall(c, idx, a);
         if (idx < 0)
             return idx;
-        notify();
+        if (coalesced)
+            property_update_coalescer::instance().schedule(&pendingNotify);
+        else
+            notify();
         return idx;
     }
 
@@ -54,18 +164,35 @@ protected:
   //  virtual void notify() = 0;
     QVariant getProperty() { accessed(); return prop.read(obj); }
     bool setProperty(const QVariant &v) { return prop.write(obj, v);  }
+
+    /* Typed access, without a QVariant: the arguments are passed to the metacall as they are,
+       so 'value' must point to an object of the exact type of the property. */
+    void readProperty(void *value) {
+        accessed();
+        int status = -1;
+        void *argv[] = { value, nullptr, &status };
+        QMetaObject::metacall(obj, QMetaObject::ReadProperty, prop.propertyIndex(), argv);
+    }
+    void writeProperty(const void *value) {
+        int status = -1;
+        int flags = 0;
+        void *argv[] = { const_cast<void *>(value), nullptr, &status, &flags };
+        QMetaObject::metacall(obj, QMetaObject::WriteProperty, prop.propertyIndex(), argv);
+    }
+    int propertyType() const { return prop.userType(); }
 };
 
 template <typename T> class property_qobject :
     public property_qobject_base {
 
 public:
-    property_qobject(::QObject *o, const char *p) : property_qobject_base(o, p) {}
+    property_qobject(::QObject *o, const char *p) : property_qobject_base(o, p),
+        typed(propertyType() == qMetaTypeId<T>()) {}
 
-    typedef std::function<T()> binding_t;
+    typedef property_function<T()> binding_t;
 
     void operator=(const T &t) {
-        setProperty(QVariant::fromValue<T>(t));
+        write(t);
         clearDependencies();
         //notify();
         //return *this;
@@ -77,6 +204,11 @@ public:
     }
 
     T get() {
+        if (typed) {
+            T t = T();
+            readProperty(&t);
+            return t;
+        }
         return qvariant_cast<T>(getProperty());
     }
 
@@ -87,7 +219,7 @@ public:
             evaluation_scope scope(this);
             data = binding();
         }
-        setProperty(QVariant::fromValue<T>(data));
+        write(data);
     }
 
     T operator->() { return get(); }
@@ -96,5 +228,16 @@ public:
 
 protected:
     binding_t binding;
+
+private:
+    void write(const T &t) {
+        if (typed)
+            writeProperty(&t);
+        else
+            setProperty(QVariant::fromValue<T>(t));
+    }
+
+    // Whether T is the type of the property, so it can be accessed without a QVariant
+    const bool typed;
 };
 
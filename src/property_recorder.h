@@ -0,0 +1,113 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PROPERTY_RECORDING
+#error "property_recorder.h requires PROPERTY_RECORDING to be defined before including property.h"
+#endif
+
+#include "property.h"
+#include "property_trace.h"
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/** Records the shape of the graph and the writes of the application to a trace, to replay
+    them later with property_replayer:
+
+      property_trace_recorder recorder("session.trace");
+      property_base::setRecorder(&recorder);
+      ...
+      property_base::setRecorder(nullptr);
+
+    Only the properties and their dependencies are recorded, not their values, so the replay
+    measures the work of the engine rather than the one of the bindings. The properties
+    existing before the recording started are added to the trace the first time they are seen,
+    with their dependencies at that time. */
+class property_trace_recorder : public property_recorder {
+public:
+  explicit property_trace_recorder(const char *path) : out(path) {}
+
+  // False if the trace could not be written
+  bool isOpen() const { return out.isOpen(); }
+
+  void created(const property_base *p) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    // The dependencies of a copy are reported right after
+    ids[p] = next++;
+    out.event(property_trace::op::create);
+  }
+  void destroyed(const property_base *p) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = ids.find(p);
+    if (it == ids.end())
+      return;
+    out.event(property_trace::op::destroy, it->second);
+    ids.erase(it);
+  }
+  void dependenciesChanged(const property_base *p, bool propagating) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    dependencies(p, propagating ? property_trace::op::evaluated : property_trace::op::dependencies);
+  }
+  void written(const property_base *p) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    out.event(property_trace::op::write, id(p));
+  }
+  void batchBegin() override {
+    std::lock_guard<std::mutex> lock(mutex);
+    out.event(property_trace::op::batch_begin);
+  }
+  void batchEnd() override {
+    std::lock_guard<std::mutex> lock(mutex);
+    out.event(property_trace::op::batch_end);
+  }
+  void cutoff(const property_base *p) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    out.event(property_trace::op::cutoff, id(p));
+  }
+
+private:
+  std::uint64_t id(const property_base *p) {
+    auto it = ids.find(p);
+    if (it != ids.end())
+      return it->second;
+    std::uint64_t i = next++;
+    ids.emplace(p, i);
+    out.event(property_trace::op::create);
+    bool any = false;
+    p->forEachDependency([&](const property_base *) { any = true; });
+    if (any)
+      dependencies(p, property_trace::op::dependencies);
+    return i;
+  }
+  void dependencies(const property_base *p, property_trace::op o) {
+    std::uint64_t i = id(p);
+    std::vector<std::uint64_t> list;
+    p->forEachDependency([&](const property_base *d) { list.push_back(id(d)); });
+    out.event(o, i, list);
+  }
+
+  property_trace::writer out;
+  std::unordered_map<const property_base *, std::uint64_t> ids;
+  std::uint64_t next = 0;
+  std::mutex mutex;
+};
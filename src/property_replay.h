@@ -0,0 +1,221 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "property.h"
+#include "property_trace.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/** Rebuilds the graph recorded by property_trace_recorder and replays its writes against the
+    engine, without the application: every recorded property becomes a node which, when
+    evaluated, accesses the dependencies recorded for it and then notifies its change, or
+    cuts off if the recorded propagation did.
+
+      property_replayer replay("session.trace");
+      if (replay.run())
+        std::cout << replay.statistics().evaluations << std::endl;
+
+    The node evaluated during a propagation take the dependencies recorded for that
+    propagation, and keep their previous ones otherwise. The lazy properties are replayed as
+    eager ones, and the iterations of a cycle are not distinguished. */
+class property_replayer {
+public:
+  struct replay_statistics {
+    std::uint64_t properties = 0;  // created by the trace
+    std::uint64_t writes = 0;
+    std::uint64_t propagations = 0;
+    std::uint64_t evaluations = 0;
+    std::uint64_t cutoffs = 0;
+    // Spent in the propagations started by the writes and the batches
+    std::chrono::nanoseconds time{0};
+  };
+
+  explicit property_replayer(const char *path) {
+    property_trace::reader in(path);
+    property_trace::event e;
+    while (in.next(e)) {
+      step s;
+      s.type = e.type;
+      s.id = e.id;
+      s.begin = ids.size();
+      ids.insert(ids.end(), e.ids.begin(), e.ids.end());
+      s.end = ids.size();
+      steps.push_back(s);
+    }
+    valid = !in.error();
+  }
+
+  // False if the trace could not be read, or is not consistent
+  bool isValid() const { return valid; }
+
+  /* Replays the whole trace, then destroys the graph. Can be called again to repeat the
+     measure. Returns false if the trace is not consistent. */
+  bool run() {
+    if (!valid)
+      return false;
+    stats = replay_statistics();
+    for (std::size_t i = 0; i < steps.size() && valid; ++i) {
+      const step &s = steps[i];
+      switch (s.type) {
+      case property_trace::op::create:
+        nodes.emplace_back(new node(*this));
+        ++stats.properties;
+        break;
+      case property_trace::op::destroy:
+        if (find(s.id))
+          nodes[std::size_t(s.id)].reset();
+        else
+          valid = false;
+        break;
+      case property_trace::op::dependencies:
+      case property_trace::op::evaluated:
+        // Not part of a propagation, like the first evaluation of a binding
+        if (node *n = find(s.id)) {
+          n->dependencies = resolve(s);
+          n->track();
+        } else {
+          valid = false;
+        }
+        break;
+      case property_trace::op::write:
+        if (node *n = find(s.id)) {
+          ++stats.writes;
+          i = propagate(i, [n]{ n->write(); }, batches.empty());
+        } else {
+          valid = false;
+        }
+        break;
+      case property_trace::op::batch_begin:
+        batches.emplace_back(new property_base::batch);
+        break;
+      case property_trace::op::batch_end:
+        if (batches.empty()) {
+          valid = false;
+          break;
+        }
+        i = propagate(i, [this]{ batches.pop_back(); }, batches.size() == 1);
+        break;
+      case property_trace::op::cutoff:
+        // Of a property evaluated outside of a propagation
+        break;
+      }
+    }
+    batches.clear();
+    nodes.clear();
+    return valid;
+  }
+
+  const replay_statistics &statistics() const { return stats; }
+
+private:
+  struct node : property_base {
+    explicit node(property_replayer &r) : replayer(r) {}
+    void evaluate() override {
+      ++replayer.stats.evaluations;
+      {
+        evaluation_scope scope(this);
+        for (node *n : dependencies)
+          n->accessed();
+      }
+      if (cut) {
+        cut = false;
+        ++replayer.stats.cutoffs;
+        cutoff();
+      } else {
+        notify();
+      }
+    }
+    void track() {
+      evaluation_scope scope(this);
+      for (node *n : dependencies)
+        n->accessed();
+    }
+    void write() { notify(); }
+
+    property_replayer &replayer;
+    // Accessed by the evaluations
+    std::vector<node *> dependencies;
+    // Whether the next evaluation cuts off
+    bool cut = false;
+  };
+
+  struct step {
+    property_trace::op type;
+    std::uint64_t id;
+    std::size_t begin, end;
+  };
+
+  node *find(std::uint64_t id) const {
+    return id < nodes.size() ? nodes[std::size_t(id)].get() : nullptr;
+  }
+  std::vector<node *> resolve(const step &s) {
+    std::vector<node *> r;
+    for (std::size_t i = s.begin; i < s.end; ++i) {
+      if (node *n = find(ids[i]))
+        r.push_back(n);
+      else
+        valid = false;
+    }
+    return r;
+  }
+
+  /* Runs f, which starts the propagation recorded by the steps following 'at' if 'starts',
+     after having planned the evaluations of that propagation. Returns the last step of the
+     propagation. */
+  template<typename F> std::size_t propagate(std::size_t at, F f, bool starts) {
+    if (!starts) {
+      f();
+      return at;
+    }
+    std::size_t last = at;
+    for (; last + 1 < steps.size(); ++last) {
+      const step &s = steps[last + 1];
+      node *n = find(s.id);
+      if (s.type == property_trace::op::evaluated && n)
+        // The engine still has the previous ones, and updates them during the evaluation
+        n->dependencies = resolve(s);
+      else if (s.type == property_trace::op::cutoff && n)
+        n->cut = true;
+      else
+        break;
+    }
+    ++stats.propagations;
+    auto start = std::chrono::steady_clock::now();
+    f();
+    stats.time += std::chrono::steady_clock::now() - start;
+    // The replay may not evaluate exactly what the recording did
+    for (std::size_t i = at + 1; i <= last; ++i) {
+      if (node *n = find(steps[i].id))
+        n->cut = false;
+    }
+    return last;
+  }
+
+  std::vector<step> steps;
+  std::vector<std::uint64_t> ids;
+  std::vector<std::unique_ptr<node>> nodes;
+  std::vector<std::unique_ptr<property_base::batch>> batches;
+  replay_statistics stats;
+  bool valid;
+};
@@ -0,0 +1,167 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#ifndef PROPERTY_THREAD_SAFE
+#error "property_scheduler.h requires PROPERTY_THREAD_SAFE to be defined before including property.h"
+#endif
+
+#include "property.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** A propagation scheduler evaluating each level of the graph on a pool of threads.
+    Every worker takes the properties from its own queue and steals from the others when it
+    is empty. The propagating thread waits for the whole level before going to the next one,
+    so a binding always sees all its dependencies up to date, as with sequential evaluation.
+    If bindings throw, the rest of the level is still evaluated, then the first exception is
+    rethrown to the propagating thread.
+
+    Bindings and hooks then run on the worker threads: they must not touch objects that are
+    bound to a thread, such as QObjects, and the lazy properties read by the bindings of a
+    level must not be stale. */
+class work_stealing_scheduler : public property_base::propagation_scheduler {
+  struct worker {
+    std::mutex mutex;
+    std::deque<property_base *> tasks;
+    std::vector<property_base *> notified;
+    std::thread thread;
+  };
+  std::vector<std::unique_ptr<worker>> workers;
+
+  std::mutex mutex;
+  std::condition_variable wakeUp, finished;
+  unsigned generation = 0;
+  bool quit = false;
+  std::atomic<std::size_t> remaining{0};
+  // Thrown by a binding during the current level, protected by 'mutex'
+  std::exception_ptr error;
+
+public:
+  explicit work_stealing_scheduler(unsigned threads = std::thread::hardware_concurrency()) {
+    if (threads == 0)
+      threads = 1;
+    for (unsigned i = 0; i < threads; ++i)
+      workers.emplace_back(new worker);
+    for (unsigned i = 0; i < threads; ++i)
+      workers[i]->thread = std::thread([this, i]{ work(i); });
+  }
+
+  ~work_stealing_scheduler() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      quit = true;
+    }
+    wakeUp.notify_all();
+    for (auto &w : workers)
+      w->thread.join();
+  }
+
+  unsigned threadCount() const { return unsigned(workers.size()); }
+
+  void evaluateLevel(const std::vector<property_base *> &level,
+                     std::vector<property_base *> &notified) override {
+    // Set first: a worker still looking for work may start before the generation changes
+    remaining = level.size();
+    // Contiguous chunks, so that neighbouring properties are likely evaluated by the same thread
+    std::size_t chunk = (level.size() + workers.size() - 1) / workers.size();
+    for (std::size_t i = 0; i < workers.size(); ++i) {
+      std::lock_guard<std::mutex> lock(workers[i]->mutex);
+      for (std::size_t j = i * chunk; j < std::min(level.size(), (i + 1) * chunk); ++j)
+        workers[i]->tasks.push_back(level[j]);
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++generation;
+    }
+    wakeUp.notify_all();
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      finished.wait(lock, [this]{ return remaining == 0; });
+    }
+    for (auto &w : workers) {
+      notified.insert(notified.end(), w->notified.begin(), w->notified.end());
+      w->notified.clear();
+    }
+    std::exception_ptr e;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      std::swap(e, error);
+    }
+    if (e)
+      std::rethrow_exception(e);
+  }
+
+private:
+  property_base *take(unsigned index) {
+    {
+      worker &own = *workers[index];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks.empty()) {
+        property_base *p = own.tasks.back();
+        own.tasks.pop_back();
+        return p;
+      }
+    }
+    for (std::size_t i = 1; i < workers.size(); ++i) {
+      worker &victim = *workers[(index + i) % workers.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        property_base *p = victim.tasks.front();
+        victim.tasks.pop_front();
+        return p;
+      }
+    }
+    return nullptr;
+  }
+
+  void work(unsigned index) {
+    unsigned seen = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wakeUp.wait(lock, [&]{ return quit || generation != seen; });
+        if (quit)
+          return;
+        seen = generation;
+      }
+      while (property_base *p = take(index)) {
+        try {
+          property_base::evaluateDetached(p, workers[index]->notified);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!error)
+            error = std::current_exception();
+        }
+        if (--remaining == 0) {
+          std::lock_guard<std::mutex> lock(mutex);
+          finished.notify_all();
+        }
+      }
+    }
+  }
+};
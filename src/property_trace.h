@@ -0,0 +1,267 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define PROPERTY_TRACE_MMAP
+#endif
+
+/** The binary format of the traces written by property_recorder.h and read by property_replay.h.
+
+    A trace starts with the 8 bytes "PROPTRC" followed by the version, then holds one event per
+    operation: its opcode byte followed by its operands, unsigned LEB128 numbers. The properties
+    are numbered in the order they were first seen, from 0, and the numbers are never reused.
+      create                      the next property number
+      destroy id
+      dependencies id n id...     the dependencies of a property set outside a propagation
+      evaluated id n id...        the dependencies of a property changed by a propagation
+      write id                    the application changed a property, or notified its change
+      batch_begin, batch_end
+      cutoff id                   a propagation evaluated the property, which did not change
+    The events of a propagation follow the write or the batch_end starting it. */
+namespace property_trace {
+
+static const char magic[8] = { 'P', 'R', 'O', 'P', 'T', 'R', 'C', 1 };
+
+enum class op : unsigned char {
+  create, destroy, dependencies, evaluated, write, batch_begin, batch_end, cutoff
+};
+
+/* Appends the events to a file. On POSIX systems the file is mapped in memory, and grown by
+   doubling its size, so writing an event is a few stores. Not thread safe. */
+class writer {
+public:
+  explicit writer(const char *path) {
+#ifdef PROPERTY_TRACE_MMAP
+    fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0 && !grow(1 << 20))
+      close();
+#else
+    file = std::fopen(path, "wb");
+    if (file)
+      buffer.resize(1 << 16);
+#endif
+    if (isOpen())
+      append(magic, sizeof(magic));
+  }
+  writer(const writer &) = delete;
+  writer &operator=(const writer &) = delete;
+  ~writer() { close(); }
+
+  // False if the file could not be created, or could not be written at some point
+  bool isOpen() const {
+#ifdef PROPERTY_TRACE_MMAP
+    return fd >= 0;
+#else
+    return file;
+#endif
+  }
+
+  void event(op o) {
+    reserve(1);
+    put(static_cast<unsigned char>(o));
+  }
+  void event(op o, std::uint64_t id) {
+    reserve(11);
+    put(static_cast<unsigned char>(o));
+    number(id);
+  }
+  void event(op o, std::uint64_t id, const std::vector<std::uint64_t> &ids) {
+    reserve(21 + 10 * ids.size());
+    put(static_cast<unsigned char>(o));
+    number(id);
+    number(ids.size());
+    for (std::uint64_t i : ids)
+      number(i);
+  }
+
+  // Writes the pending events and truncates the file to its content
+  void close() {
+#ifdef PROPERTY_TRACE_MMAP
+    if (fd < 0)
+      return;
+    if (data)
+      ::munmap(data, capacity);
+    if (::ftruncate(fd, off_t(size))) {}
+    ::close(fd);
+    fd = -1;
+    data = nullptr;
+#else
+    if (!file)
+      return;
+    flush();
+    std::fclose(file);
+    file = nullptr;
+#endif
+  }
+
+private:
+  void put(unsigned char c) { data[size++] = c; }
+  void number(std::uint64_t n) {
+    while (n >= 0x80) {
+      put(static_cast<unsigned char>(n | 0x80));
+      n >>= 7;
+    }
+    put(static_cast<unsigned char>(n));
+  }
+  void append(const void *bytes, std::size_t n) {
+    reserve(n);
+    std::memcpy(data + size, bytes, n);
+    size += n;
+  }
+
+#ifdef PROPERTY_TRACE_MMAP
+  // Makes room for n more bytes; on failure the trace is closed and writes go to a scratch buffer
+  void reserve(std::size_t n) {
+    if (size + n <= capacity)
+      return;
+    if (fd >= 0) {
+      std::size_t c = std::max<std::size_t>(capacity, 1 << 20);
+      while (c < size + n)
+        c *= 2;
+      if (grow(c))
+        return;
+      close();
+    }
+    scratch.resize(n);
+    data = scratch.data();
+    size = 0;
+    capacity = n;
+  }
+  bool grow(std::size_t c) {
+    if (data)
+      ::munmap(data, capacity);
+    data = nullptr;
+    if (::ftruncate(fd, off_t(c)))
+      return false;
+    void *p = ::mmap(nullptr, c, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+      return false;
+    data = static_cast<unsigned char *>(p);
+    capacity = c;
+    return true;
+  }
+  int fd = -1;
+  std::size_t capacity = 0;
+#else
+  void reserve(std::size_t n) {
+    if (size + n > buffer.size()) {
+      flush();
+      if (n > buffer.size())
+        buffer.resize(n);
+    }
+    data = buffer.data();
+  }
+  void flush() {
+    if (file && std::fwrite(buffer.data(), 1, size, file) != size) {
+      std::fclose(file);
+      file = nullptr;
+    }
+    size = 0;
+  }
+  std::FILE *file = nullptr;
+  std::vector<unsigned char> buffer;
+#endif
+  std::vector<unsigned char> scratch;
+  unsigned char *data = nullptr;
+  std::size_t size = 0;
+};
+
+struct event {
+  op type;
+  std::uint64_t id = 0;
+  std::vector<std::uint64_t> ids;
+};
+
+/* Reads the events of a trace, which is loaded in memory at once. */
+class reader {
+public:
+  explicit reader(const char *path) {
+    if (std::FILE *file = std::fopen(path, "rb")) {
+      unsigned char chunk[1 << 16];
+      std::size_t n;
+      while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+        content.insert(content.end(), chunk, chunk + n);
+      std::fclose(file);
+    }
+    valid = content.size() >= sizeof(magic) && !std::memcmp(content.data(), magic, sizeof(magic));
+    position = sizeof(magic);
+  }
+
+  /* Reads the next event into e. Returns false at the end of the trace, or if it is not
+     a trace or is truncated, in which case error() is true. */
+  bool next(event &e) {
+    if (!valid || position == content.size())
+      return false;
+    unsigned char o = content[position++];
+    if (o > static_cast<unsigned char>(op::cutoff))
+      return fail();
+    e.type = static_cast<op>(o);
+    e.ids.clear();
+    switch (e.type) {
+    case op::create: case op::batch_begin: case op::batch_end:
+      return true;
+    case op::destroy: case op::write: case op::cutoff:
+      return number(e.id);
+    case op::dependencies: case op::evaluated: {
+      std::uint64_t n;
+      if (!number(e.id) || !number(n) || n > content.size() - position)
+        return fail();
+      e.ids.resize(std::size_t(n));
+      for (std::uint64_t &i : e.ids) {
+        if (!number(i))
+          return false;
+      }
+      return true;
+    }
+    }
+    return fail();
+  }
+
+  bool error() const { return !valid; }
+
+private:
+  bool number(std::uint64_t &n) {
+    n = 0;
+    for (unsigned shift = 0; position < content.size() && shift < 64; shift += 7) {
+      unsigned char c = content[position++];
+      n |= std::uint64_t(c & 0x7f) << shift;
+      if (!(c & 0x80))
+        return true;
+    }
+    return fail();
+  }
+  bool fail() { valid = false; return false; }
+
+  std::vector<unsigned char> content;
+  std::size_t position;
+  bool valid;
+};
+
+}
@@ -26,17 +26,46 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace QtWrapper {
 
 template<class Base> struct Widget : Base {
-    template<typename... Args> Widget(Args &&...args) : Base(std::forward<Args>(args)...) {}
+    template<typename... Args> Widget(Args &&...args) : Base(std::forward<Args>(args)...) {
+        geometryNotify.notify = [this]{ geometry.notify(); };
+        geometry.setName("geometry");
+    }
+    ~Widget() {
+        if (geometryNotify.queued)
+            property_update_coalescer::instance().cancel(&geometryNotify);
+    }
+    /* The Move and Resize events notify the wrapper, so geometry.setCached(true) keeps the
+       last geometry instead of asking the widget on every read. Qt defers these events
+       while the widget is hidden: in cached mode, a resize() or move() called directly on
+       a hidden widget is only seen once it is shown. */
     property_wrapper<QRect> geometry{
         [this](const QRect &r){ this->setGeometry(r); },
         [this]() { return this->Base::geometry(); } };
 
+    /* In coalesced mode, the Move and Resize events are propagated to the bindings once per
+       event loop iteration. Until then, the bindings depending on geometry keep their value,
+       while geometry() returns the new geometry, or the previous one in cached mode.
+       Leaving it propagates the pending change right away. */
+    void setGeometryCoalesced(bool c) {
+        coalesceGeometry = c;
+        if (!c && geometryNotify.queued) {
+            property_update_coalescer::instance().cancel(&geometryNotify);
+            geometry.notify();
+        }
+    }
+
 private:
+    property_update_coalescer::entry geometryNotify;
+    bool coalesceGeometry = false;
+
     virtual bool event(QEvent* e) override {
         switch(e->type()) {
             case QEvent::Move:
             case QEvent::Resize:
-                geometry.notify();
+                if (coalesceGeometry)
+                    property_update_coalescer::instance().schedule(&geometryNotify);
+                else
+                    geometry.notify();
                 break;
             default:
                 break;
@@ -0,0 +1,156 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+#include "property.h"
+
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/* Static property graphs: the dependencies of each binding are part of its type, so the
+   propagation order is fixed at compile time and updating the graph is a sequence of
+   inlined calls guarded by constant bit masks, without any runtime bookkeeping.
+
+   A static_graph is made of nodes, which can only depend on the nodes declared before them:
+
+     auto rect = make_static_graph(
+         static_source<int>(150),                                        // 0: width
+         static_source<int>(75),                                         // 1: height
+         static_bind<int, 0, 1>([](int w, int h) { return w * h / 2; })); // 2: area
+     rect.set<0>(10);
+     int area = rect.get<2>();
+
+   The whole graph is also a property_base: bindings of dynamic properties reading get<I>()
+   are re-evaluated when the graph changes, and static_input nodes follow a property<T>. */
+
+// A node whose value is set with static_graph::set()
+template <typename T> struct static_source {
+  typedef T value_type;
+  explicit static_source(T v = T()) : value(std::move(v)) {}
+  T value;
+};
+
+// A node following the value of a dynamic property
+template <typename T> struct static_input {
+  typedef T value_type;
+  explicit static_input(const property<T> &p) : input(&p), value() {}
+  const property<T> *input;
+  T value;
+};
+
+// A node computed by F from the values of the nodes at the indexes Deps
+template <typename T, typename F, std::size_t... Deps> struct static_binding {
+  typedef T value_type;
+  explicit static_binding(F f) : function(std::move(f)), value() {}
+  F function;
+  T value;
+};
+
+template <typename T, std::size_t... Deps, typename F>
+static_binding<T, F, Deps...> static_bind(F f) { return static_binding<T, F, Deps...>(std::move(f)); }
+
+namespace static_property_detail {
+template <std::size_t... I> struct mask : std::integral_constant<std::uint64_t, 0> {};
+template <std::size_t I, std::size_t... Rest> struct mask<I, Rest...>
+    : std::integral_constant<std::uint64_t, (std::uint64_t(1) << I) | mask<Rest...>::value> {};
+
+template <std::size_t... I> struct all_below : std::true_type {};
+template <std::size_t N, std::size_t I, std::size_t... Rest> struct all_below<N, I, Rest...>
+    : std::integral_constant<bool, (I < N) && all_below<N, Rest...>::value> {};
+
+template <std::size_t I> using index = std::integral_constant<std::size_t, I>;
+}
+
+template <typename... Nodes>
+class static_graph : public property_base {
+  static_assert(sizeof...(Nodes) <= 64, "a static_graph has at most 64 nodes");
+  template <std::size_t I> using node_t = typename std::tuple_element<I, std::tuple<Nodes...>>::type;
+  template <std::size_t I> using bit = std::integral_constant<std::uint64_t, std::uint64_t(1) << I>;
+
+  std::tuple<Nodes...> nodes;
+  // The nodes changed since the last update
+  std::uint64_t dirty = ~std::uint64_t(0);
+
+public:
+  explicit static_graph(Nodes... n) : nodes(std::move(n)...) { evaluate(); }
+
+  template <std::size_t I> const typename node_t<I>::value_type &get() const {
+    const_cast<static_graph *>(this)->accessed();
+    return std::get<I>(nodes).value;
+  }
+
+  template <std::size_t I> void set(typename node_t<I>::value_type v) {
+    static_assert(std::is_same<node_t<I>, static_source<typename node_t<I>::value_type>>::value,
+                  "only static_source nodes can be set");
+    std::get<I>(nodes).value = std::move(v);
+    dirty |= bit<I>::value;
+    update();
+  }
+
+  // Reads the static_input nodes again
+  void evaluate() override {
+    {
+      evaluation_scope scope(this);
+      read(static_property_detail::index<0>());
+    }
+    update();
+  }
+
+private:
+  void update() {
+    updateFrom(static_property_detail::index<0>());
+    dirty = 0;
+    notify();
+  }
+
+  template <std::size_t I> void updateFrom(static_property_detail::index<I>) {
+    updateNode<I>(std::get<I>(nodes));
+    updateFrom(static_property_detail::index<I + 1>());
+  }
+  void updateFrom(static_property_detail::index<sizeof...(Nodes)>) {}
+
+  template <std::size_t I, typename T, typename F, std::size_t... Deps>
+  void updateNode(static_binding<T, F, Deps...> &n) {
+    static_assert(static_property_detail::all_below<I, Deps...>::value,
+                  "a static binding can only depend on the nodes declared before it");
+    if (dirty & static_property_detail::mask<Deps...>::value) {
+      n.value = n.function(std::get<Deps>(nodes).value...);
+      dirty |= bit<I>::value;
+    }
+  }
+  template <std::size_t I, typename N> void updateNode(N &) {}
+
+  template <std::size_t I> void read(static_property_detail::index<I>) {
+    readNode<I>(std::get<I>(nodes));
+    read(static_property_detail::index<I + 1>());
+  }
+  void read(static_property_detail::index<sizeof...(Nodes)>) {}
+
+  template <std::size_t I, typename T> void readNode(static_input<T> &n) {
+    n.value = n.input->get();
+    dirty |= bit<I>::value;
+  }
+  template <std::size_t I, typename N> void readNode(N &) {}
+};
+
+template <typename... Nodes> static_graph<Nodes...> make_static_graph(Nodes... n) {
+  return static_graph<Nodes...>(std::move(n)...);
+}
@@ -0,0 +1,109 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* Asynchronous bindings: the results are published on the main thread by the dispatcher,
+   and the results of superseded evaluations are dropped. */
+
+#include <cassert>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include "property.h"
+#include "property_async.h"
+
+std::mutex mutex;
+std::condition_variable posted;
+bool ready = false;
+
+property_dispatcher dispatcher([]{
+  std::lock_guard<std::mutex> lock(mutex);
+  ready = true;
+  posted.notify_all();
+});
+
+// Publishes the results as they arrive, until the property got its own
+template <typename T> void drain(const async_property<T> &p) {
+  while (p.isPending()) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      posted.wait(lock, []{ return ready; });
+      ready = false;
+    }
+    dispatcher.drain();
+  }
+}
+
+// Blocks the tasks until it is opened
+struct gate {
+  std::mutex m;
+  std::condition_variable cv;
+  bool open = false;
+  void wait() { std::unique_lock<std::mutex> lock(m); cv.wait(lock, [this]{ return open; }); }
+  void release() { std::lock_guard<std::mutex> lock(m); open = true; cv.notify_all(); }
+};
+
+int main() {
+  property_thread_pool pool(1);
+  property<int> source = 3;
+  int tasks = 0;
+  async_property<int> square(pool, dispatcher, [&]{
+    int v = source;
+    return [v, &tasks]{ ++tasks; return v * v; };
+  });
+  int evaluations = 0;
+  property<int> plusOne = [&]{ ++evaluations; return square + 1; };
+  assert(square.isPending() && square == 0 && plusOne == 1);
+  drain(square);
+  assert(!square.isPending() && square == 9 && plusOne == 10);
+
+  // The first task is blocked while the source changes twice: only the last one is computed
+  gate g;
+  pool.execute([&]{ g.wait(); });
+  source = 4;
+  source = 5;
+  g.release();
+  drain(square);
+  assert(square == 25 && tasks == 2);
+
+  // A task running while the source changes: its result is dropped
+  gate running, done;
+  int slowEvaluations = 0;
+  async_property<int> slow(pool, dispatcher, [&]{
+    int v = source;
+    return [v, &running, &done]{ running.release(); done.wait(); return v; };
+  });
+  property<int> slowPlusOne = [&]{ ++slowEvaluations; return slow + 1; };
+  running.wait();
+  source = 6;
+  done.release();
+  drain(slow);
+  assert(slow == 6 && slowPlusOne == 7 && slowEvaluations == 2);
+
+  // A property destroyed before its result arrives
+  {
+    async_property<int> temporary(pool, dispatcher, [&]{ int v = source; return [v]{ return v; }; });
+  }
+  drain(square);
+  gate last;
+  pool.execute([&]{ last.release(); });
+  last.wait();
+  dispatcher.drain();
+
+  std::cout << "ok" << std::endl;
+}
@@ -0,0 +1,79 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* The statistics recorded when PROPERTY_INSTRUMENTATION is defined, and their dumps. */
+
+#define PROPERTY_INSTRUMENTATION
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "property.h"
+#include "property_instrumentation.h"
+
+int main() {
+  property<int> width = 2;
+  property<int> height = 3;
+  property<int> area = [&]{ return width * height; };
+  property<int> perimeter = [&]{ return 2 * (width + height); };
+  property<int> ratio = [&]{ return area * 100 / perimeter; };
+  width.setName("width");
+  area.setName("area");
+  ratio.setName("ratio \"%\"");
+
+  property_base::resetStatistics();
+  width = 4;
+  width = 5;
+  assert(width.statistics().notifications == 2);
+  assert(area.statistics().evaluations == 2);
+  assert(ratio.statistics().evaluations == 2);
+  assert(height.statistics().evaluations == 0);
+  assert(width.fanOut() == 2 && width.fanIn() == 0);
+  assert(ratio.fanIn() == 2 && ratio.depth() == 2);
+
+  std::vector<property_base *> hot = property_instrumentation::hotList(2);
+  assert(hot.size() == 2);
+  assert(hot[0]->statistics().time >= hot[1]->statistics().time);
+  // Only the bindings spend time evaluating
+  assert(hot[0] != &width && hot[0] != &height);
+
+  std::ostringstream json;
+  property_instrumentation::writeJson(json);
+  assert(json.str().find("\"name\":\"ratio \\\"%\\\"\",\"evaluations\":2") != std::string::npos);
+  assert(json.str().find("\"edges\":[") != std::string::npos);
+
+  std::ostringstream dot;
+  property_instrumentation::writeDot(dot);
+  assert(dot.str().compare(0, 20, "digraph properties {") == 0);
+  std::size_t edges = 0;
+  for (std::size_t i = 0; (i = dot.str().find(" -> ", i)) != std::string::npos; ++i)
+    ++edges;
+  assert(edges == 6);
+
+  {
+    property<int> temporary = [&]{ return area + 1; };
+    std::size_t live = 0;
+    property_base::forEachInstance([&](property_base *) { ++live; });
+    assert(live == 6);
+  }
+  std::size_t live = 0;
+  property_base::forEachInstance([&](property_base *) { ++live; });
+  assert(live == 5);
+  std::cout << "ok" << std::endl;
+}
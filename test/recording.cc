@@ -0,0 +1,148 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* Recording of a graph and of its writes with PROPERTY_RECORDING, and the replay of the trace,
+   which must evaluate the same properties as the recorded propagations. */
+
+#define PROPERTY_RECORDING
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "property.h"
+#include "property_recorder.h"
+#include "property_replay.h"
+
+static const char *path = "recording.trace";
+
+int main() {
+  int evaluations = 0;
+  {
+    // Exists before the recording, and is added to the trace when first written
+    property<int> early = 1;
+    property<int> earlyDouble = [&]{ ++evaluations; return early * 2; };
+
+    property_trace_recorder recorder(path);
+    assert(recorder.isOpen());
+    property_base::setRecorder(&recorder);
+    {
+      property<int> a = 1, b = 2, flag = 0;
+      property<int> sum = [&]{ ++evaluations; return a + b; };
+      property<int> pick = [&]{ ++evaluations; return flag ? a.get() : b.get(); };
+      property<int> parity;
+      parity.setEqualityCutoff(true);
+      parity = [&]{ ++evaluations; return sum % 2; };
+      property<int> out = [&]{ ++evaluations; return parity + pick + earlyDouble; };
+      evaluations = 0;
+
+      // parity does not change, so out is not evaluated
+      a = 3;
+      assert(evaluations == 2);
+      // pick now depends on a instead of b
+      flag = 1;
+      assert(evaluations == 4);
+      a = 4;
+      assert(evaluations == 8);
+      {
+        property_base::batch batch;
+        a = 5;
+        b = 6;
+      }
+      assert(evaluations == 12);
+      early = 2;
+      assert(evaluations == 14);
+      {
+        property<int> temporary = [&]{ ++evaluations; return out + 1; };
+        property<int> copy = sum;
+        evaluations = 14;
+        // copy keeps the binding and the dependencies of sum
+        a = 6;
+        assert(evaluations == 20);
+      }
+    }
+    property_base::setRecorder(nullptr);
+  }
+
+  property_replayer replay(path);
+  assert(replay.isValid());
+  for (int i = 0; i < 2; ++i) {
+    assert(replay.run());
+    const property_replayer::replay_statistics &s = replay.statistics();
+    assert(s.evaluations == std::uint64_t(evaluations));
+    assert(s.cutoffs == 1);
+    assert(s.writes >= 7 && s.propagations >= 7);
+    (void)s;
+  }
+
+  // A destroyed property is removed from the dependencies of its subscribers
+  evaluations = 0;
+  {
+    property_trace_recorder recorder(path);
+    property_base::setRecorder(&recorder);
+    {
+      property<int> offset = 0;
+      std::vector<std::unique_ptr<property<int>>> items;
+      for (int i = 0; i < 3; ++i)
+        items.emplace_back(new property<int>(i));
+      property<int> sum = [&]{
+        ++evaluations;
+        int s = offset;
+        for (auto &item : items)
+          s += item->get();
+        return s;
+      };
+      evaluations = 0;
+      items.erase(items.begin() + 1);
+      offset = 10;
+      assert(sum == 12 && evaluations == 1);
+      *items[1] = 5;
+      assert(sum == 15 && evaluations == 2);
+    }
+    property_base::setRecorder(nullptr);
+  }
+  {
+    property_replayer destroyed(path);
+    assert(destroyed.run());
+    assert(destroyed.statistics().evaluations == std::uint64_t(evaluations));
+  }
+
+  // A trace that cannot be written does not stop the recording
+  {
+    property_trace_recorder unwritable("/nonexistent-directory/recording.trace");
+    assert(!unwritable.isOpen());
+    property_base::setRecorder(&unwritable);
+    property<int> source = 1;
+    property<int> doubled = [&]{ return source * 2; };
+    for (int i = 0; i < 100000; ++i)
+      source = i;
+    assert(doubled == 2 * 99999);
+    property_base::setRecorder(nullptr);
+  }
+
+  // Not a trace
+  {
+    std::FILE *f = std::fopen(path, "wb");
+    std::fputs("PROPERTY", f);
+    std::fclose(f);
+  }
+  assert(!property_replayer(path).isValid());
+  std::remove(path);
+  std::cout << "ok" << std::endl;
+}
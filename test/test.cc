@@ -17,8 +17,18 @@ OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 #include <iostream>
 #include "property.h"
+#include "property_array.h"
+#include "static_property.h"
+#include "property_collection.h"
 
 int calculateArea(int width, int height) {
   return (width * height) * 0.5;
@@ -38,7 +48,494 @@ struct rectangle {
   };
 };
 
+// A property reachable through two paths is evaluated once, and never sees half-updated inputs.
+void testDiamond() {
+  int evaluations = 0;
+  property<int> source = 1;
+  property<int> twice = [&]{ return source * 2; };
+  property<int> thrice = [&]{ return source * 3; };
+  property<int> sum = [&]{
+    ++evaluations;
+    assert(twice * 3 == thrice * 2);
+    return twice + thrice;
+  };
+  evaluations = 0;
+  source = 2;
+  assert(evaluations == 1);
+  assert(sum == 10);
+}
+
+// A lazy property is only evaluated when it is read.
+void testLazy() {
+  int evaluations = 0;
+  property<int> source = 1;
+  property<int> lazy = [&]{ ++evaluations; return source * 2; };
+  lazy.setLazy(true);
+  property<int> derived = [&]{ return lazy + 1; };
+  derived.setLazy(true);
+  evaluations = 0;
+  for (int i = 0; i < 10; ++i)
+    source = i;
+  assert(evaluations == 0);
+  assert(derived == 19);
+  assert(evaluations == 1);
+  assert(lazy == 18);
+  assert(evaluations == 1);
+}
+
+// Changes done in a batch are propagated once, when the outermost batch ends.
+void testBatch() {
+  int evaluations = 0;
+  property<int> width = 1;
+  property<int> height = 1;
+  property<int> area = [&]{ ++evaluations; return width * height; };
+  evaluations = 0;
+  {
+    property_base::batch b;
+    width = 2;
+    {
+      property_base::batch nested;
+      height = 3;
+    }
+    assert(evaluations == 0);
+    assert(area == 1);
+    width = 4;
+  }
+  assert(evaluations == 1);
+  assert(area == 12);
+}
+
+// The dependencies follow what the binding accessed on its last evaluation.
+void testDynamicDependencies() {
+  int evaluations = 0;
+  property<bool> useFirst = true;
+  property<int> first = 1;
+  property<int> second = 2;
+  property<int> selected = [&]{ ++evaluations; return useFirst ? first + first : second + 0; };
+  assert(selected == 2);
+  evaluations = 0;
+  second = 3;
+  assert(evaluations == 0);
+  useFirst = false;
+  assert(selected == 3);
+  evaluations = 0;
+  first = 4;
+  assert(evaluations == 0);
+  second = 5;
+  assert(evaluations == 1);
+  assert(selected == 5);
+  useFirst = true;
+  first = 6;
+  assert(selected == 12);
+}
+
+// A binding that evaluates to the same value does not re-evaluate its subscribers.
+void testCutoff() {
+  int evaluations = 0;
+  property<int> width = 10;
+  property<int> area = [&]{ return calculateArea(width, 1); };
+  area.setEqualityCutoff(true);
+  property<int> perimeter = [&]{ ++evaluations; return area * 4; };
+  evaluations = 0;
+  unsigned long cutoffs = property_base::cutoffStatistics().cutoffs;
+  width = 11;
+  assert(evaluations == 0);
+  assert(property_base::cutoffStatistics().cutoffs == cutoffs + 1);
+  width = 12;
+  assert(evaluations == 1);
+  assert(perimeter == 24);
+}
+
+// A static graph updates in declaration order, and interoperates with dynamic properties.
+void testStaticGraph() {
+  property<int> scale = 2;
+  auto rect = make_static_graph(
+      static_source<int>(150),
+      static_source<int>(75),
+      static_input<int>(scale),
+      static_bind<int, 0, 1>([](int w, int h) { return calculateArea(w, h); }),
+      static_bind<int, 3, 2>([](int area, int s) { return area * s; }));
+  assert(rect.get<4>() == 11250);
+  property<int> scaledArea = [&]{ return rect.get<4>(); };
+  rect.set<0>(10);
+  assert(scaledArea == 750);
+  scale = 3;
+  assert(scaledArea == 1125);
+}
+
+void testCachedWrapper() {
+  int value = 1, reads = 0;
+  property_wrapper<int> wrapper([&](int v) { value = v; }, [&] { ++reads; return value; });
+  wrapper.setCached(true);
+  property<int> doubled = [&]{ return wrapper() * 2; };
+  assert(doubled == 2 && wrapper() == 1 && reads == 1);
+  wrapper = 4;
+  assert(doubled == 8 && reads == 2);
+  value = 5; // changed behind the wrapper's back: stale until notified
+  assert(wrapper() == 4);
+  wrapper.notify();
+  assert(doubled == 10 && reads == 3);
+  assert(&wrapper.getReference() == &wrapper.getReference() && reads == 3);
+}
+
+void testCycles() {
+  // Celsius and Fahrenheit bound to each other: each new binding closes a cycle
+  property<double> celsius = 0;
+  property<double> fahrenheit = [&]{ return celsius * 9 / 5 + 32; };
+  celsius = [&]{ return (fahrenheit - 32) * 5 / 9; };
+  assert(property_base::cycleStatistics().cycles == 1);
+  unsigned long truncated = property_base::cycleStatistics().truncated;
+  fahrenheit = 212; // not a binding anymore, the cycle is gone
+  assert(celsius == 100);
+  assert(property_base::cycleStatistics().truncated == truncated);
+
+  property<int> source = 1;
+  int evaluations = 0;
+  property<int> a = [&]{ return source(); };
+  property<int> b = [&]{ ++evaluations; return a() + 1; };
+  a = [&]{ return source() + b() % 10; };
+  assert(property_base::cycleStatistics().cycles == 2);
+  truncated = property_base::cycleStatistics().truncated;
+  evaluations = 0;
+  source = 2; // a is evaluated once, then b, and the cycle is broken there
+  assert(evaluations == 1 && b == a + 1);
+  assert(property_base::cycleStatistics().truncated == truncated + 1);
+
+  // Once the cycle is gone, the evaluations follow the dependencies again
+  property<int> input = 1;
+  property<int> first = [&]{ return input + 1; };
+  property<int> second = [&]{ return first + 1; };
+  first = [&]{ return input + second * 0 + 1; };
+  second = [&]{ return input * 10; };
+  first = [&]{ return input + second; };
+  input = 2;
+  assert(second == 20 && first == 22);
+  input = 3;
+  assert(first == 33);
+
+  // A counter converging to 10, with the equality cutoff stopping the iterations
+  property_base::setCyclePolicy(property_base::cycle_policy::fixed_point, 100);
+  property<int> start = 0;
+  property<int> counter = [&]{ return start(); };
+  counter.setEqualityCutoff(true);
+  property<int> next = [&]{ return std::min(counter() + 1, 10); };
+  counter = [&]{ return std::max(start(), next()); };
+  start = 1;
+  assert(counter == 10 && next == 10);
+
+  property_base::setCyclePolicy(property_base::cycle_policy::reject);
+  property<int> x = 1;
+  property<int> y = [&]{ return x() + 1; };
+  x = [&]{ return y() + 1; }; // x does not depend on y
+  assert(x == 3 && y == 4);
+  property_base::setCyclePolicy(property_base::cycle_policy::break_after_one_pass);
+}
+
+void testMoveAndModify() {
+  std::vector<int> items(100, 1);
+  const int *storage = items.data();
+  property<std::vector<int>> list = std::move(items);
+  int evaluations = 0;
+  property<std::size_t> count = [&]{ ++evaluations; return list().size(); };
+  assert(list().data() == storage && count == 100);
+
+  evaluations = 0;
+  list.modify([](std::vector<int> &v) { v.push_back(2); v.push_back(3); });
+  assert(evaluations == 1 && count == 102);
+
+  std::vector<int> other(10, 4);
+  storage = other.data();
+  list = std::move(other);
+  assert(list().data() == storage && count == 10 && evaluations == 2);
+}
+
+void testCollections() {
+  property_list<int> list;
+  int calls = 0;
+  auto squares = make_list_map(list, [&](int v) { ++calls; return v * v; });
+  auto even = make_list_filter(squares, [](int v) { return v % 2 == 0; });
+  auto sum = make_sum(even);
+  auto odd = make_count(list, [](int v) { return v % 2 != 0; });
+  property<int> total = [&]{ return sum + int(odd); };
+
+  // Random edits, checked against the operators computed from scratch
+  unsigned seed = 1;
+  auto random = [&](unsigned n) { seed = seed * 1103515245 + 12345; return (seed >> 16) % n; };
+  for (int i = 0; i < 500; ++i) {
+    std::size_t n = list.size();
+    switch (n ? random(3) : 0) {
+      case 0: list.insert(random(unsigned(n) + 1), int(random(100))); break;
+      case 1: list.erase(random(unsigned(n))); break;
+      case 2: list.set(random(unsigned(n)), int(random(100))); break;
+    }
+    int expectedSum = 0, expectedOdd = 0;
+    std::vector<int> expectedEven;
+    for (int v : list.get()) {
+      if (v % 2 == 0) {
+        expectedEven.push_back(v * v);
+        expectedSum += v * v;
+      } else {
+        ++expectedOdd;
+      }
+    }
+    assert(squares.size() == list.size() && even.get() == expectedEven);
+    assert(total == expectedSum + expectedOdd);
+  }
+  // One call per inserted or updated element
+  assert(calls <= 500);
+
+  {
+    property_base::batch b;
+    for (int i = 0; i < 10; ++i)
+      list.push_back(i);
+  }
+  list.assign({ 1, 2, 3 });
+  assert(even.get() == std::vector<int>{ 4 } && total == 4 + 2);
+
+  property_map<std::string, int> stock;
+  auto units = make_sum(stock);
+  auto empty = make_count(stock, [](int v) { return v == 0; });
+  stock.set("apples", 3);
+  stock.set("pears", 0);
+  stock.set("apples", 5);
+  assert(units == 5 && empty == 1);
+  stock.erase("pears");
+  assert(units == 5 && empty == 0);
+}
+
+// A binding that throws stops its propagation, and the following ones run normally.
+void testExceptions() {
+  property<int> source = 1;
+  property<int> checked = [&]{
+    if (source == 2)
+      throw std::runtime_error("invalid");
+    return source * 2;
+  };
+  property<int> other = [&]{ return source + 1; };
+  bool thrown = false;
+  try {
+    source = 2;
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  assert(thrown);
+  source = 3;
+  assert(checked == 6 && other == 4);
+
+  thrown = false;
+  try {
+    property_base::batch batch;
+    source = 2;
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  assert(thrown);
+  source = 4;
+  assert(checked == 8 && other == 5);
+}
+
+// Assigning a property copies its binding and its dependencies, and keeps its subscribers.
+void testCopyAssignment() {
+  property<int> source = 2;
+  property<int> bound = [&]{ return source * 3; };
+  property<int> watcher = [&]{ return bound + 1; };
+  property<int> copy = 5;
+  property<int> copyWatcher = [&]{ return copy * 2; };
+  copy = bound;
+  assert(copy == 6 && copyWatcher == 12);
+  source = 3;
+  assert(copy == 9 && copyWatcher == 18 && watcher == 10);
+  property<int> &same = copy;
+  copy = same;
+  assert(copy == 9);
+  property<int> plain = 7;
+  copy = plain;
+  source = 4;
+  assert(copy == 7 && copyWatcher == 14 && bound == 12);
+
+  // Copying the binding of a property depending on this one closes a cycle
+  property<int> a = 1;
+  property<int> b = [&]{ return a + 1; };
+  property<int> c = [&]{ return b + 1; };
+  unsigned long cycles = property_base::cycleStatistics().cycles;
+  a = c;
+  assert(property_base::cycleStatistics().cycles == cycles + 1);
+  // One pass around the cycle
+  assert(a == 5 && b == 6 && c == 7);
+  property_base::setCyclePolicy(property_base::cycle_policy::reject);
+  property<int> d = [&]{ return c + 1; };
+  property<int> e = [&]{ return d + 1; };
+  c = e;
+  assert(property_base::cycleStatistics().cycles == cycles + 2);
+  // c does not depend on d
+  assert(c == 9 && d == 10);
+  a = 0;
+  assert(c == 9 && d == 10);
+  property_base::setCyclePolicy(property_base::cycle_policy::break_after_one_pass);
+}
+
+static int fortyTwo() { return 42; }
+
+// Small callables are stored inline, bigger ones on the heap; both are copied and moved.
+void testPropertyFunction() {
+  std::shared_ptr<int> counter = std::make_shared<int>(1);
+  {
+    property_function<int()> small = [counter]{ return *counter; };
+    struct { char bytes[64]; } padding = {};
+    property_function<int()> big = [counter, padding]{ return *counter + padding.bytes[0]; };
+    assert(small() == 1 && big() == 1 && counter.use_count() == 3);
+
+    property_function<int()> smallCopy = small, bigCopy = big;
+    assert(counter.use_count() == 5);
+    *counter = 2;
+    assert(smallCopy() == 2 && bigCopy() == 2);
+
+    property_function<int()> smallMoved = std::move(smallCopy), bigMoved = std::move(bigCopy);
+    assert(!smallCopy && !bigCopy && smallMoved() == 2 && bigMoved() == 2);
+    assert(counter.use_count() == 5);
+
+    big = small;
+    assert(big() == 2 && counter.use_count() == 5);
+    small = nullptr;
+    assert(!small && counter.use_count() == 4);
+  }
+  assert(counter.use_count() == 1);
+
+  int (*noFunction)() = nullptr;
+  property_function<int()> fromNull = noFunction, fromNullptr = nullptr;
+  property_function<int()> fromEmpty = std::function<int()>();
+  assert(!fromNull && !fromNullptr && !fromEmpty);
+  property_function<int()> fromPointer = &fortyTwo, fromFunction = std::function<int()>(&fortyTwo);
+  assert(fromPointer() == 42 && fromFunction() == 42);
+  property_function<long(int, int)> converting = [](int a, int b) { return a * b; };
+  assert(converting(6, 7) == 42);
+}
+
+// make_property() stores the lambda in the property; a new binding or a value replaces it.
+void testBoundProperty() {
+  int evaluations = 0;
+  property<int> source = 1;
+  auto doubled = make_property([&]{ ++evaluations; return source * 2; });
+  property<int> watcher = [&]{ return doubled + 1; };
+  assert(doubled == 2 && watcher == 3);
+  evaluations = 0;
+  source = 2;
+  assert(evaluations == 1 && doubled == 4 && watcher == 5);
+
+  doubled = [&]{ return source * 10; };
+  assert(doubled == 20 && watcher == 21);
+  source = 3;
+  assert(doubled == 30 && watcher == 31 && evaluations == 1);
+
+  doubled = 7;
+  source = 4;
+  assert(doubled == 7 && watcher == 8 && evaluations == 1);
+}
+
+// Without PROPERTY_THREAD_SAFE, independent graphs still work in parallel threads.
+void testIndependentThreads() {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([t]{
+      for (int round = 0; round < 20; ++round) {
+        property<int> source = t;
+        std::vector<std::unique_ptr<property<int>>> nodes;
+        for (int i = 0; i < 100; ++i)
+          nodes.emplace_back(new property<int>([&source, i]{ return source + i; }));
+        property<long> sum = [&]{
+          long s = 0;
+          for (auto &n : nodes)
+            s += n->get();
+          return s;
+        };
+        source = round;
+        assert(sum == 100 * round + 99 * 100 / 2);
+      }
+    });
+  }
+  for (std::thread &t : threads)
+    t.join();
+}
+
+// A column bound to other columns is recomputed when any of their elements changes.
+void testArray() {
+  property_array<int> a(4, 1), b(4, 2), sum(4);
+  sum.bind([](int x, int y) { return x + y; }, a, b);
+  int evaluations = 0;
+  property<int> total = [&]{
+    ++evaluations;
+    int s = 0;
+    for (std::size_t i = 0; i < sum.size(); ++i)
+      s += sum[i];
+    return s;
+  };
+  assert(total == 12);
+
+  evaluations = 0;
+  a.set(1, 10);
+  assert(sum[1] == 12 && total == 21 && evaluations == 1);
+  b.update([](int *data, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i)
+      data[i] = int(i);
+  });
+  assert(sum[0] == 1 && sum[1] == 11 && sum[3] == 4 && total == 19 && evaluations == 2);
+  a.fill(5);
+  assert(sum.data()[2] == 7 && total == 26 && evaluations == 3);
+
+  a.resize(6, 1);
+  b.resize(6, 2);
+  sum.resize(6);
+  assert(sum.size() == 6 && sum[5] == 3 && total == 32);
+
+  // An element set directly replaces the binding
+  sum.set(0, 100);
+  evaluations = 0;
+  a.fill(0);
+  assert(sum[0] == 100 && evaluations == 0);
+  assert(sum[1] == 6 && total == 100 + 6 + 7 + 8 + 3 + 3);
+}
+
+static property<int> makeTemporary(int v) { return property<int>(v); }
+
+// Edges from the system allocator, so that a memory checker sees the ones used after free
+struct system_allocator : property_allocator {
+  void *allocate(std::size_t size) override { return ::operator new(size); }
+  void deallocate(void *p, std::size_t) override { ::operator delete(p); }
+};
+
+// A dependency destroyed while the binding reading it is still running.
+void testTemporaryDependency() {
+  system_allocator system;
+  property_allocator *previous = property_base::setAllocator(&system);
+  {
+    property<int> x = 1;
+    property<int> y = [&]{ return x() + makeTemporary(5).get() + makeTemporary(10).get(); };
+    assert(y == 16);
+    x = 2;
+    assert(y == 17);
+  }
+  property_base::setAllocator(previous);
+}
+
 int main() {
+  testDiamond();
+  testLazy();
+  testBatch();
+  testDynamicDependencies();
+  testCutoff();
+  testStaticGraph();
+  testCachedWrapper();
+  testCycles();
+  testMoveAndModify();
+  testCollections();
+  testExceptions();
+  testCopyAssignment();
+  testPropertyFunction();
+  testBoundProperty();
+  testIndependentThreads();
+  testArray();
+  testTemporaryDependency();
+
   rectangle parent;
   rectangle child;
   child.parent = &parent;
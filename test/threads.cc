@@ -0,0 +1,126 @@
+/* Copyright (C) 2013 Olivier Goffart <ogoffart@woboq.com>
+   http://woboq.com/blog/property-bindings-in-cpp.html
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial
+portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/* Several threads evaluating their own graphs, which all depend on shared properties.
+   The bindings keep changing their dependencies, so the subscriber lists of the shared
+   properties are modified concurrently. */
+
+#define PROPERTY_THREAD_SAFE
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "property.h"
+#include "property_scheduler.h"
+
+property<int> scale = 3;
+property<int> offset = 7;
+
+void worker(int seed) {
+  property<int> source = seed;
+  std::vector<std::unique_ptr<property<int>>> nodes;
+  for (int i = 0; i < 50; ++i) {
+    nodes.emplace_back(new property<int>([&source, i]{
+      // odd values depend on 'scale', even ones on 'offset'
+      return source % 2 ? source * scale + i : source + offset + i;
+    }));
+  }
+  property<long> sum = [&]{
+    long s = 0;
+    for (auto &n : nodes)
+      s += n->get();
+    return s;
+  };
+  for (int i = 0; i < 2000; ++i) {
+    source = seed + i;
+    long v = seed + i;
+    assert(sum == 50 * (v % 2 ? v * 3 : v + 7) + 49 * 50 / 2);
+  }
+}
+
+// Evaluating the levels of a graph in parallel gives the same result as sequentially.
+void testScheduler() {
+  work_stealing_scheduler scheduler(4);
+  property<int> source = 1;
+  std::vector<std::unique_ptr<property<int>>> layer1, layer2;
+  for (int i = 0; i < 100; ++i)
+    layer1.emplace_back(new property<int>([&source, i]{ return source * scale + i; }));
+  for (int i = 0; i < 100; ++i) {
+    property<int> *a = layer1[i].get(), *b = layer1[(i + 1) % 100].get();
+    layer2.emplace_back(new property<int>([a, b]{ return *a - *b; }));
+  }
+  property<long> sum = [&]{
+    long s = 0;
+    for (auto &n : layer2)
+      s += n->get() * n->get();
+    return s;
+  };
+  property_base::setScheduler(&scheduler);
+  for (int i = 0; i < 200; ++i) {
+    source = i;
+    assert(sum == 99 + 99 * 99);
+    assert(*layer1[42] == i * 3 + 42);
+  }
+  property_base::setScheduler(nullptr);
+}
+
+// A binding throwing on a worker thread: the exception reaches the write, and the
+// propagations go on afterwards.
+void testSchedulerException() {
+  work_stealing_scheduler scheduler(4);
+  property<int> source = 1;
+  std::vector<std::unique_ptr<property<int>>> layer;
+  for (int i = 0; i < 100; ++i) {
+    layer.emplace_back(new property<int>([&source, i]{
+      if (i == 42 && source == 5)
+        throw std::runtime_error("invalid");
+      return source + i;
+    }));
+  }
+  property<long> sum = [&]{
+    long s = 0;
+    for (auto &n : layer)
+      s += n->get();
+    return s;
+  };
+  property_base::setScheduler(&scheduler);
+  bool thrown = false;
+  try {
+    source = 5;
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  assert(thrown);
+  source = 6;
+  assert(sum == 600 + 99 * 100 / 2 && *layer[42] == 48);
+  property_base::setScheduler(nullptr);
+}
+
+int main() {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t)
+    threads.emplace_back(worker, t * 1000);
+  for (std::thread &t : threads)
+    t.join();
+  testScheduler();
+  testSchedulerException();
+  std::cout << "ok" << std::endl;
+}